@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CSRGraph.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Synthetic word-association graph: node i is named "w<i>", degrees follow
+ * a power law and weights are association strengths in [0.01, 1] with two
+ * decimals, skewed towards weak links like the hand-made inputs.
+ */
+struct SyntheticGraph {
+        std::vector<std::string> names;
+        std::vector<CSRGraph<NodeWeight>::Edge> edges;
+};
+
+/**
+ * @brief Chung-Lu style generator: both endpoints of every edge are drawn with
+ * probability proportional to (i + 1)^(-1 / (exponent - 1)), which gives a degree
+ * distribution with tail exponent `exponent`. Self loops are redrawn, parallel
+ * edges are kept. The same seed always yields the same graph.
+ */
+inline SyntheticGraph GeneratePowerLaw(size_t nodeCount, size_t edgeCount, double exponent = 2.1,
+                                       uint64_t seed = 1) {
+    if (nodeCount < 2 || exponent <= 1.0)
+        throw(std::invalid_argument("need at least two nodes and an exponent above 1"));
+
+    SyntheticGraph graph;
+    graph.names.reserve(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++)
+        graph.names.push_back("w" + std::to_string(i));
+
+    std::vector<double> popularity(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++)
+        popularity[i] = std::pow((double)(i + 1), -1.0 / (exponent - 1.0));
+
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<NodeID> endpoint(popularity.begin(), popularity.end());
+    std::uniform_real_distribution<double> strength(0.0, 1.0);
+
+    // a permutation keeps the hubs from all sitting at the lowest IDs
+    std::vector<NodeID> order(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++)
+        order[i] = (NodeID)i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    graph.edges.reserve(edgeCount);
+    while (graph.edges.size() < edgeCount) {
+        NodeID from = order[endpoint(rng)], to = order[endpoint(rng)];
+        if (from == to)
+            continue;
+
+        double u = strength(rng);
+        NodeWeight weight = std::max(1.0, std::round(u * u * 100.0)) / 100.0;
+        graph.edges.push_back({from, to, weight});
+    }
+
+    return graph;
+}
+
+// "source target weight" lines, see Graph::LoadEdgeList
+inline void WriteEdgeList(const std::string &filename, const SyntheticGraph &graph) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    std::string buffer;
+    char number[32];
+
+    for (const auto &edge : graph.edges) {
+        buffer += graph.names[edge.from];
+        buffer += ' ';
+        buffer += graph.names[edge.to];
+        buffer += ' ';
+        buffer.append(number, std::to_chars(number, number + sizeof(number), edge.weight,
+                                            std::chars_format::fixed, 2)
+                                  .ptr);
+        buffer += '\n';
+
+        if (buffer.size() > (1 << 20)) {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    file.write(buffer.data(), buffer.size());
+    if (!file)
+        throw(std::runtime_error("cannot write " + filename));
+}
+
+// node count, node names and the dense V x V weight matrix, see Graph::LoadFromFile;
+// parallel edges collapse to the lighter one
+inline void WriteAdjacencyMatrix(const std::string &filename, const SyntheticGraph &graph) {
+    const size_t n = graph.names.size();
+    CSRGraph<NodeWeight> csr(n, graph.edges);
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+    std::string buffer = std::to_string(n) + "\n";
+    for (size_t i = 0; i < n; i++)
+        buffer += graph.names[i] + (i + 1 < n ? " " : "\n");
+
+    std::vector<NodeWeight> row(n);
+    char number[32];
+
+    for (NodeID u = 0; u < n; u++) {
+        std::fill(row.begin(), row.end(), 0.0);
+
+        // rows are sorted by weight, so walking them backwards leaves the minimum
+        for (size_t i = csr.Degree(u); i-- > 0;)
+            row[csr.Targets(u)[i]] = csr.Weights(u)[i];
+
+        for (size_t v = 0; v < n; v++) {
+            if (row[v] == 0.0)
+                buffer += '0';
+            else
+                buffer.append(number, std::to_chars(number, number + sizeof(number), row[v],
+                                                    std::chars_format::fixed, 2)
+                                          .ptr);
+
+            buffer += v + 1 < n ? ' ' : '\n';
+        }
+
+        if (buffer.size() > (1 << 20)) {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    file.write(buffer.data(), buffer.size());
+    if (!file)
+        throw(std::runtime_error("cannot write " + filename));
+}
\ No newline at end of file
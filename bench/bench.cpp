@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// build bench
+// g++ bench/bench.cpp -o bench_spa -O2 -Iincl/ -Ibench/ -std=c++23 -pthread
+//
+// run
+// bench_spa --nodes 1000,10000,100000 --degree 8 --format csv --out results.csv
+//
+// add -DSPA_ENABLE_STATS to also get the hot-path counters (see Stats.hpp) on stderr
+
+#include "./Generator.hpp"
+#include "./../incl/Graph.hpp"
+
+struct Options {
+        std::vector<size_t> nodes = {1000, 10000};
+        double degree = 8.0;
+        double exponent = 2.1;
+        uint64_t seed = 1;
+        size_t threads = 0;
+        size_t repeat = 3;
+        size_t queries = 100;
+        size_t maxMatrix = 2000;     // largest V written as a dense matrix for LoadFromFile
+        size_t maxAllPairs = 5000;   // largest V for InitDistances / DumpData (V^2 memory)
+        size_t maxHierarchy = 20000; // largest V for BuildHierarchy
+        std::string format = "json";
+        std::string out;
+        std::string dir = "bench_data";
+        bool keep = false;
+};
+
+struct Result {
+        std::string name;
+        size_t nodes;
+        size_t edges;
+        size_t threads;
+        size_t repeat;
+        size_t operations; // per repetition, e.g. queried sources
+        double best;       // seconds
+        double median;     // seconds
+};
+
+static void usage() {
+    std::cout << "usage: bench [--nodes N[,N...]] [--degree D] [--exponent X] [--seed S]\n"
+                 "             [--threads T] [--repeat R] [--queries Q] [--max-matrix N]\n"
+                 "             [--max-all-pairs N] [--max-hierarchy N] [--format json|csv]\n"
+                 "             [--out FILE] [--dir DIR] [--keep]\n";
+}
+
+static Options parse_options(int argC, char **argV) {
+    Options options;
+
+    for (int i = 1; i < argC; i++) {
+        std::string arg = argV[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argC)
+                throw(std::invalid_argument(arg + " expects a value"));
+            return argV[++i];
+        };
+
+        if (arg == "--nodes") {
+            options.nodes.clear();
+            std::stringstream list(value());
+            for (std::string item; std::getline(list, item, ',');)
+                options.nodes.push_back(std::stoull(item));
+        } else if (arg == "--degree") {
+            options.degree = std::stod(value());
+        } else if (arg == "--exponent") {
+            options.exponent = std::stod(value());
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(value());
+        } else if (arg == "--threads") {
+            options.threads = std::stoull(value());
+        } else if (arg == "--repeat") {
+            options.repeat = std::max<size_t>(1, std::stoull(value()));
+        } else if (arg == "--queries") {
+            options.queries = std::max<size_t>(1, std::stoull(value()));
+        } else if (arg == "--max-matrix") {
+            options.maxMatrix = std::stoull(value());
+        } else if (arg == "--max-all-pairs") {
+            options.maxAllPairs = std::stoull(value());
+        } else if (arg == "--max-hierarchy") {
+            options.maxHierarchy = std::stoull(value());
+        } else if (arg == "--format") {
+            options.format = value();
+        } else if (arg == "--out") {
+            options.out = value();
+        } else if (arg == "--dir") {
+            options.dir = value();
+        } else if (arg == "--keep") {
+            options.keep = true;
+        } else {
+            usage();
+            throw(std::invalid_argument("unknown option " + arg));
+        }
+    }
+
+    if (options.format != "json" && options.format != "csv")
+        throw(std::invalid_argument("unknown format " + options.format));
+
+    return options;
+}
+
+// runs prepare() untimed and body() timed, `repeat` times
+template <typename Prepare, typename Body>
+static Result measure(const std::string &name, const Options &options, size_t nodes,
+                      size_t edges, size_t operations, Prepare &&prepare, Body &&body) {
+    std::vector<double> seconds;
+
+    for (size_t r = 0; r < options.repeat; r++) {
+        prepare();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        seconds.push_back(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    std::cerr << "  " << name << ": " << seconds.front() << " s" << std::endl;
+
+    return {name,           nodes,         edges, ResolveThreadCount(options.threads),
+            options.repeat, operations, seconds.front(), seconds[seconds.size() / 2]};
+}
+
+static void bench_size(size_t nodes, const Options &options, std::vector<Result> &results) {
+    using GraphType = Graph<std::string>;
+    const size_t edges = (size_t)(nodes * options.degree);
+    std::cerr << "V = " << nodes << ", E = " << edges << std::endl;
+
+    const std::filesystem::path dir = options.dir;
+    const std::string edgeFile = (dir / ("graph_" + std::to_string(nodes) + ".edges")).string();
+    const std::string matrixFile = (dir / ("graph_" + std::to_string(nodes) + ".txt")).string();
+
+    SyntheticGraph synthetic;
+    results.push_back(measure(
+        "Generate", options, nodes, edges, 1, [] {},
+        [&] { synthetic = GeneratePowerLaw(nodes, edges, options.exponent, options.seed); }));
+
+    WriteEdgeList(edgeFile, synthetic);
+
+    // the same random sources for every query benchmark
+    std::mt19937_64 rng(options.seed);
+    std::vector<Node<std::string>> sources;
+    for (size_t i = 0; i < options.queries; i++)
+        sources.emplace_back(synthetic.names[rng() % nodes]);
+
+    const bool allPairs = nodes <= options.maxAllPairs;
+    auto fresh = [&](GraphType &graph) {
+        graph = GraphType();
+        graph.SetThreadCount(options.threads);
+        graph.SetOutDir((dir / "").string());
+    };
+
+    GraphType graph;
+    results.push_back(measure("LoadEdgeList", options, nodes, edges, 1, [&] { fresh(graph); },
+                              [&] { graph.LoadEdgeList(edgeFile); }));
+
+    if (nodes <= options.maxMatrix) {
+        WriteAdjacencyMatrix(matrixFile, synthetic);
+
+        GraphType matrixGraph;
+        results.push_back(measure("LoadFromFile", options, nodes, edges, 1,
+                                  [&] { fresh(matrixGraph); },
+                                  [&] { matrixGraph.LoadFromFile(matrixFile); }));
+    }
+
+    graph.GetCSR(); // fold the edges in before timing queries
+    const size_t fullRuns = std::max<size_t>(1, options.queries / 10);
+
+    results.push_back(measure(
+        "Dijkstra", options, nodes, edges, fullRuns, [&] { graph.SetCacheBudget(0); },
+        [&] {
+            for (size_t i = 0; i < fullRuns; i++)
+                graph.Dijkstra(sources[i]);
+        }));
+
+    results.push_back(measure(
+        "GetClosest", options, nodes, edges, sources.size(), [&] { graph.SetCacheBudget(0); },
+        [&] {
+            for (const Node<std::string> &source : sources)
+                graph.GetClosest(source, 5);
+        }));
+
+    results.push_back(measure(
+        "KNearestBatch", options, nodes, edges, sources.size(), [&] { graph.SetCacheBudget(0); },
+        [&] { graph.KNearestBatch(sources, 5); }));
+
+    results.push_back(measure(
+        "GetClosestCached", options, nodes, edges, sources.size(),
+        [&] {
+            graph.SetCacheBudget(SourceCache<NodeWeight>::DEFAULT_BUDGET);
+            for (const Node<std::string> &source : sources)
+                graph.GetClosest(source, 5);
+        },
+        [&] {
+            for (const Node<std::string> &source : sources)
+                graph.GetClosest(source, 5);
+        }));
+
+    results.push_back(measure("ShortestPath", options, nodes, edges, sources.size(), [] {}, [&] {
+        for (size_t i = 0; i < sources.size(); i++)
+            graph.ShortestPath(sources[i], sources[(i + 1) % sources.size()]);
+    }));
+
+    if (nodes <= options.maxHierarchy) {
+        results.push_back(measure("BuildHierarchy", options, nodes, edges, 1, [] {},
+                                  [&] { graph.BuildHierarchy(); }));
+
+        results.push_back(
+            measure("ShortestPathHierarchy", options, nodes, edges, sources.size(), [] {}, [&] {
+                for (size_t i = 0; i < sources.size(); i++)
+                    graph.ShortestPath(sources[i], sources[(i + 1) % sources.size()]);
+            }));
+    }
+
+    // the same queries on fixed-point weights, i.e. a quarter of the weight memory
+    // and a radix heap instead of the 4-ary one
+    using FixedGraph = Graph<std::string, uint16_t>;
+    FixedGraph fixedGraph;
+    results.push_back(measure(
+        "LoadEdgeListFixed", options, nodes, edges, 1,
+        [&] {
+            fixedGraph = FixedGraph();
+            fixedGraph.SetThreadCount(options.threads);
+        },
+        [&] { fixedGraph.LoadEdgeList(edgeFile); }));
+
+    fixedGraph.GetCSR();
+    results.push_back(measure(
+        "DijkstraFixed", options, nodes, edges, fullRuns, [&] { fixedGraph.SetCacheBudget(0); },
+        [&] {
+            for (size_t i = 0; i < fullRuns; i++)
+                fixedGraph.Dijkstra(sources[i]);
+        }));
+
+    results.push_back(measure("GetClosestFixed", options, nodes, edges, sources.size(),
+                              [&] { fixedGraph.SetCacheBudget(0); },
+                              [&] {
+                                  for (const Node<std::string> &source : sources)
+                                      fixedGraph.GetClosest(source, 5);
+                              }));
+
+    size_t visited = 0;
+    results.push_back(measure("DFS", options, nodes, edges, fullRuns, [] {}, [&] {
+        for (size_t i = 0; i < fullRuns; i++)
+            graph.template DFS<void>(sources[i], [&](Node<std::string>, uint32_t) { visited++; });
+    }));
+
+    // the top-5 table DumpData prints, filled by bounded searches; asking for k = 1
+    // first replaces the table, so that every timed call builds it again
+    results.push_back(measure("NearestTable", options, nodes, edges, nodes,
+                              [&] { graph.GetNearestTable(1); },
+                              [&] { graph.GetNearestTable(5); }));
+
+    if (allPairs) {
+        results.push_back(measure("HopDistances", options, nodes, edges, 1, [] {}, [&] {
+            BitParallelBFS<NodeWeight>::Run(graph.GetCSR(), options.threads);
+        }));
+        results.push_back(measure("InitDistances", options, nodes, edges, 1, [] {},
+                                  [&] { graph.InitDistances(); }));
+        results.push_back(
+            measure("DumpData", options, nodes, edges, 1, [] {}, [&] { graph.DumpData(); }));
+    }
+}
+
+static void write_results(std::ostream &os, const std::vector<Result> &results,
+                          const std::string &format) {
+    if (format == "csv") {
+        os << "name,nodes,edges,threads,repeat,operations,best_s,median_s\n";
+        for (const Result &r : results)
+            os << r.name << "," << r.nodes << "," << r.edges << "," << r.threads << ","
+               << r.repeat << "," << r.operations << "," << r.best << "," << r.median << "\n";
+        return;
+    }
+
+    os << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        os << "  {\"name\": \"" << r.name << "\", \"nodes\": " << r.nodes
+           << ", \"edges\": " << r.edges << ", \"threads\": " << r.threads
+           << ", \"repeat\": " << r.repeat << ", \"operations\": " << r.operations
+           << ", \"best_s\": " << r.best << ", \"median_s\": " << r.median << "}"
+           << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
+
+int main(int argC, char **argV) {
+    try {
+        Options options = parse_options(argC, argV);
+        std::filesystem::create_directories(options.dir);
+
+        std::vector<Result> results;
+        for (size_t nodes : options.nodes)
+            bench_size(nodes, options, results);
+
+        if (options.out.empty()) {
+            write_results(std::cout, results, options.format);
+        } else {
+            std::ofstream file(options.out, std::ios::trunc);
+            write_results(file, results, options.format);
+        }
+
+        if (GetRuntimeStats().enabled)
+            std::cerr << GetRuntimeStats().ToJson() << std::endl;
+
+        if (!options.keep)
+            std::filesystem::remove_all(options.dir);
+    } catch (const std::exception &e) {
+        std::cout << "[!] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
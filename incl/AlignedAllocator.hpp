@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @brief Standard allocator whose blocks start on an `Alignment`-byte boundary, so
+ * e.g. a std::vector of doubles can be processed with aligned SIMD loads.
+ *
+ * @tparam T element data type
+ * @tparam Alignment power of two, at least alignof(T)
+ */
+template <typename T, size_t Alignment = 64> class AlignedAllocator {
+        static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "alignment is below the natural one");
+
+    public:
+        using value_type = T;
+
+        template <typename U> struct rebind {
+                using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept {}
+        template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(size_t count) {
+            return (T *)::operator new(count * sizeof(T), std::align_val_t(Alignment));
+        }
+
+        void deallocate(T *data, size_t) noexcept {
+            ::operator delete(data, std::align_val_t(Alignment));
+        }
+
+        template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const {
+            return true;
+        }
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CSRGraph.hpp"
+#include "Parallel.hpp"
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Dense all-pairs hop-count table: row `source` holds the fewest edges on
+ * any path to every target, InfinityOf<uint32_t>() for unreachable targets.
+ * Unlike DistanceTable::Hops, which counts the edges of the lightest paths, this is
+ * the unweighted metric.
+ */
+class HopTable {
+    private:
+        size_t m_NodeCount = 0;
+        std::vector<uint32_t> m_Hops;
+
+    public:
+        HopTable() {}
+
+        // every cell starts out unreachable
+        explicit HopTable(size_t nodeCount)
+            : m_NodeCount(nodeCount), m_Hops(nodeCount * nodeCount, InfinityOf<uint32_t>()) {
+            SPA_STAT_ADD(bytesAllocated, MemoryUsage());
+        }
+
+        bool Empty() const { return m_NodeCount == 0; }
+        size_t NodeCount() const { return m_NodeCount; }
+
+        uint32_t Hops(NodeID source, NodeID target) const {
+            return m_Hops[(size_t)source * m_NodeCount + target];
+        }
+
+        bool Reachable(NodeID source, NodeID target) const {
+            return Hops(source, target) != InfinityOf<uint32_t>();
+        }
+
+        std::span<const uint32_t> Row(NodeID source) const {
+            return std::span<const uint32_t>(m_Hops).subspan((size_t)source * m_NodeCount,
+                                                             m_NodeCount);
+        }
+
+        // distinct rows may be filled from different threads
+        std::span<uint32_t> MutableRow(NodeID source) {
+            return std::span<uint32_t>(m_Hops).subspan((size_t)source * m_NodeCount,
+                                                       m_NodeCount);
+        }
+
+        size_t MemoryUsage() const { return m_Hops.capacity() * sizeof(uint32_t); }
+};
+
+/**
+ * @brief All-sources BFS that runs LANES traversals at once.
+ *
+ * Each node carries one machine word per state: bit i of frontier[v] says that
+ * source i reached v on the previous level, so a single scan of v's edges advances
+ * every search of the batch that is at v. Sources of a batch are consecutive IDs,
+ * which tend to share most of their reach, so a batch of 64 costs little more than
+ * one BFS. Batches are independent and fill disjoint table rows, so they run on
+ * the worker threads, each in its own thread-local workspace.
+ *
+ * @tparam W edge weight data type, ignored
+ */
+template <typename W = NodeWeight> class BitParallelBFS {
+    public:
+        static constexpr size_t LANES = 64;
+
+        static HopTable Run(const CSRGraph<W> &csr, size_t threadCount = 0) {
+            HopTable table(csr.NodeCount());
+            const size_t batches = (csr.NodeCount() + LANES - 1) / LANES;
+
+            ParallelFor(batches, threadCount, [&](size_t batch, size_t) {
+                run_batch(csr, (NodeID)(batch * LANES), table);
+            });
+
+            return table;
+        }
+
+    private:
+        struct Workspace {
+                std::vector<uint64_t> seen;     // sources that reached the node so far
+                std::vector<uint64_t> frontier; // sources that reached it last level
+                std::vector<uint64_t> next;     // sources reaching it this level
+                std::vector<NodeID> active;     // nodes with a non-empty frontier
+                std::vector<NodeID> touched;    // nodes with a non-empty next
+        };
+
+        static Workspace &local_workspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        // BFS from the sources first .. first + LANES - 1 at once
+        static void run_batch(const CSRGraph<W> &csr, NodeID first, HopTable &table) {
+            const size_t n = csr.NodeCount();
+            const size_t lanes = std::min(LANES, n - first);
+            Workspace &ws = local_workspace();
+
+            ws.seen.assign(n, 0);
+            ws.frontier.assign(n, 0);
+            ws.next.assign(n, 0);
+            ws.active.clear();
+
+            for (size_t lane = 0; lane < lanes; lane++) {
+                NodeID source = first + (NodeID)lane;
+                ws.seen[source] = ws.frontier[source] = 1ull << lane;
+                ws.active.push_back(source);
+                table.MutableRow(source)[source] = 0;
+            }
+
+            for (uint32_t level = 1; !ws.active.empty(); level++) {
+                ws.touched.clear();
+
+                for (NodeID v : ws.active) {
+                    const uint64_t bits = ws.frontier[v];
+                    ws.frontier[v] = 0;
+
+                    for (NodeID w : csr.Targets(v)) {
+                        uint64_t fresh = bits & ~ws.seen[w];
+                        if (fresh == 0)
+                            continue;
+
+                        if (ws.next[w] == 0)
+                            ws.touched.push_back(w);
+
+                        ws.next[w] |= fresh;
+                    }
+                }
+
+                ws.active.clear();
+                for (NodeID w : ws.touched) {
+                    uint64_t fresh = ws.next[w];
+                    ws.next[w] = 0;
+                    ws.seen[w] |= fresh;
+                    ws.frontier[w] = fresh;
+                    ws.active.push_back(w);
+
+                    for (; fresh != 0; fresh &= fresh - 1)
+                        table.MutableRow(first + (NodeID)std::countr_zero(fresh))[w] = level;
+                }
+            }
+        }
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Contiguous read-mostly array that either owns its elements or views memory
+ * owned by someone else, typically a memory-mapped snapshot kept alive through
+ * the shared keep-alive handle. Copies of a mapped buffer share the mapping.
+ *
+ * @tparam T trivially copyable element type
+ */
+template <typename T> class Buffer {
+    private:
+        std::vector<T> m_Owned;
+        std::span<const T> m_View;
+        std::shared_ptr<const void> m_KeepAlive;
+
+    public:
+        Buffer() {}
+        Buffer(std::vector<T> &&owned) : m_Owned(std::move(owned)) {}
+        Buffer(const std::vector<T> &owned) : m_Owned(owned) {}
+
+        static Buffer Map(std::span<const T> view, std::shared_ptr<const void> keepAlive) {
+            Buffer buffer;
+            buffer.m_View = view;
+            buffer.m_KeepAlive = std::move(keepAlive);
+            return buffer;
+        }
+
+        bool IsMapped() const { return m_KeepAlive != nullptr; }
+
+        const T *data() const { return IsMapped() ? m_View.data() : m_Owned.data(); }
+        size_t size() const { return IsMapped() ? m_View.size() : m_Owned.size(); }
+        bool empty() const { return size() == 0; }
+
+        const T &operator[](size_t idx) const { return data()[idx]; }
+        const T *begin() const { return data(); }
+        const T *end() const { return data() + size(); }
+
+        std::span<const T> View() const { return {data(), size()}; }
+
+        // writable access, a mapped buffer is copied into owned memory first
+        std::vector<T> &Owned() {
+            if (IsMapped()) {
+                m_Owned.assign(m_View.begin(), m_View.end());
+                m_View = {};
+                m_KeepAlive.reset();
+            }
+
+            return m_Owned;
+        }
+
+        size_t MemoryUsage() const { return IsMapped() ? 0 : m_Owned.capacity() * sizeof(T); }
+};
\ No newline at end of file
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Immutable compressed-sparse-row adjacency. The outgoing edges of node u
+ * occupy the half-open range [offsets[u], offsets[u + 1]) of the contiguous
+ * target and weight arrays, sorted ascendingly by weight within each row.
+ * The arrays are either owned or mapped straight out of a snapshot file.
+ *
+ * @tparam W edge weight data type
+ */
+template <typename W = NodeWeight> class CSRGraph {
+    public:
+        struct Edge {
+                NodeID from;
+                NodeID to;
+                W weight;
+        };
+
+    private:
+        Buffer<size_t> m_Offsets = std::vector<size_t>{0};
+        Buffer<NodeID> m_Targets;
+        Buffer<W> m_Weights;
+
+    public:
+        CSRGraph() {}
+
+        // builds the rows with a counting sort over the source IDs, O(V + E)
+        CSRGraph(size_t nodeCount, const std::vector<Edge> &edges) {
+            std::vector<size_t> offsets(nodeCount + 1, 0);
+            std::vector<NodeID> targets(edges.size());
+            std::vector<W> weights(edges.size());
+
+            for (const Edge &edge : edges) {
+                if (edge.from >= nodeCount || edge.to >= nodeCount)
+                    throw(std::out_of_range(std::to_string(std::max(edge.from, edge.to))));
+
+                offsets[edge.from + 1]++;
+            }
+
+            for (size_t u = 0; u < nodeCount; u++)
+                offsets[u + 1] += offsets[u];
+
+            std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (const Edge &edge : edges) {
+                size_t slot = cursor[edge.from]++;
+                targets[slot] = edge.to;
+                weights[slot] = edge.weight;
+            }
+
+            sort_rows(offsets, targets, weights);
+            adopt(std::move(offsets), std::move(targets), std::move(weights));
+        }
+
+        // adopts rows that were already assembled in CSR shape, e.g. by a loader
+        // reading an adjacency matrix row by row
+        CSRGraph(std::vector<size_t> &&offsets, std::vector<NodeID> &&targets,
+                 std::vector<W> &&weights) {
+            validate(offsets, targets, weights);
+            sort_rows(offsets, targets, weights);
+            adopt(std::move(offsets), std::move(targets), std::move(weights));
+        }
+
+        // views rows that are already sorted, e.g. sections of a mapped snapshot
+        static CSRGraph Map(std::span<const size_t> offsets, std::span<const NodeID> targets,
+                            std::span<const W> weights, std::shared_ptr<const void> keepAlive) {
+            validate(offsets, targets, weights);
+
+            CSRGraph csr;
+            csr.m_Offsets = Buffer<size_t>::Map(offsets, keepAlive);
+            csr.m_Targets = Buffer<NodeID>::Map(targets, keepAlive);
+            csr.m_Weights = Buffer<W>::Map(weights, keepAlive);
+            return csr;
+        }
+
+        bool IsMapped() const { return m_Targets.IsMapped(); }
+
+        size_t NodeCount() const { return m_Offsets.size() - 1; }
+        size_t EdgeCount() const { return m_Targets.size(); }
+
+        size_t Degree(NodeID u) const { return m_Offsets[u + 1] - m_Offsets[u]; }
+
+        std::span<const NodeID> Targets(NodeID u) const {
+            return {m_Targets.data() + m_Offsets[u], Degree(u)};
+        }
+
+        std::span<const W> Weights(NodeID u) const {
+            return {m_Weights.data() + m_Offsets[u], Degree(u)};
+        }
+
+        std::span<const size_t> Offsets() const { return m_Offsets.View(); }
+        std::span<const NodeID> Targets() const { return m_Targets.View(); }
+        std::span<const W> Weights() const { return m_Weights.View(); }
+
+        // unpacks the rows back into an edge list, used when the graph is mutated
+        std::vector<Edge> Edges() const {
+            std::vector<Edge> result;
+            result.reserve(EdgeCount());
+
+            for (NodeID u = 0; u < NodeCount(); u++)
+                for (size_t i = m_Offsets[u]; i < m_Offsets[u + 1]; i++)
+                    result.push_back({u, m_Targets[i], m_Weights[i]});
+
+            return result;
+        }
+
+        // the same nodes with every edge reversed, i.e. row v lists the edges into v
+        CSRGraph Transpose() const {
+            std::vector<Edge> edges = Edges();
+            for (Edge &edge : edges)
+                std::swap(edge.from, edge.to);
+
+            return CSRGraph(NodeCount(), edges);
+        }
+
+        // heap bytes held by the graph, mapped rows do not count
+        size_t MemoryUsage() const {
+            return m_Offsets.MemoryUsage() + m_Targets.MemoryUsage() + m_Weights.MemoryUsage();
+        }
+
+    private:
+        void adopt(std::vector<size_t> &&offsets, std::vector<NodeID> &&targets,
+                   std::vector<W> &&weights) {
+            m_Offsets = std::move(offsets);
+            m_Targets = std::move(targets);
+            m_Weights = std::move(weights);
+            SPA_STAT_ADD(bytesAllocated, MemoryUsage());
+        }
+
+        static void validate(std::span<const size_t> offsets, std::span<const NodeID> targets,
+                             std::span<const W> weights) {
+            if (offsets.empty() || offsets.front() != 0 || offsets.back() != targets.size() ||
+                targets.size() != weights.size())
+                throw(std::invalid_argument("malformed CSR rows"));
+
+            for (size_t u = 0; u + 1 < offsets.size(); u++)
+                if (offsets[u] > offsets[u + 1])
+                    throw(std::invalid_argument("malformed CSR rows"));
+
+            for (NodeID target : targets)
+                if (target >= offsets.size() - 1)
+                    throw(std::out_of_range(std::to_string(target)));
+        }
+
+        static void sort_rows(const std::vector<size_t> &offsets, std::vector<NodeID> &targets,
+                              std::vector<W> &weights) {
+            std::vector<std::pair<W, NodeID>> row;
+
+            for (size_t u = 0; u + 1 < offsets.size(); u++) {
+                size_t begin = offsets[u], end = offsets[u + 1];
+                if (end - begin < 2)
+                    continue;
+
+                row.clear();
+                for (size_t i = begin; i < end; i++)
+                    row.emplace_back(weights[i], targets[i]);
+
+                std::sort(row.begin(), row.end());
+
+                for (size_t i = begin; i < end; i++) {
+                    weights[i] = row[i - begin].first;
+                    targets[i] = row[i - begin].second;
+                }
+            }
+        }
+};
\ No newline at end of file
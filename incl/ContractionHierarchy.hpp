@@ -0,0 +1,547 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "CSRGraph.hpp"
+#include "Heap.hpp"
+#include "ShortestPaths.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Contraction-hierarchy index for repeated point-to-point queries on a
+ * graph that does not change between them.
+ *
+ * Build contracts the nodes one by one, cheapest first by edge difference
+ * (shortcuts added minus edges removed, plus the already contracted neighbors so
+ * the order stays spread out). A shortcut u -> x through v is only added when a
+ * bounded witness search finds no path of at most the same weight around v. The
+ * index keeps, for every node, the arcs towards nodes contracted after it: "up"
+ * arcs leave the node, "down" arcs enter it. A query runs Dijkstra upwards from
+ * both ends and meets at the highest node of the path; shortcuts remember the
+ * node they bypass, so the path is unpacked back into original edges.
+ *
+ * The arc arrays are either owned or mapped straight out of a snapshot file.
+ *
+ * @tparam W edge weight data type, arcs and distances are PathWeightOf<W> so a
+ * shortcut holds the sum of the edges it bypasses
+ * @tparam Heap addressable min-heap, see Heap.hpp
+ */
+template <typename W = NodeWeight, typename Heap = DefaultHeap<PathWeightOf<W>>>
+class ContractionHierarchy {
+    public:
+        using PathWeight = PathWeightOf<W>;
+
+        struct Arc {
+                NodeID target; // the far end, i.e. the source for down arcs
+                NodeID via;    // bypassed node of a shortcut, INVALID_NODE for an edge
+                PathWeight weight;
+        };
+
+        using Path = typename ShortestPaths<W>::Path;
+
+        // witness searches give up after settling this many nodes, which only ever
+        // costs a superfluous shortcut, never a wrong answer
+        static constexpr size_t WITNESS_LIMIT = 64;
+
+        // nodes with more in x out neighbor pairs than this are ordered by that product
+        // alone until contracting them comes up, sparing the hubs' witness searches
+        static constexpr size_t SIMULATE_LIMIT = 1024;
+
+        class Workspace {
+                friend class ContractionHierarchy;
+
+            private:
+                std::vector<PathWeight> m_Distances;
+                std::vector<NodeID> m_Parents;
+                std::vector<NodeID> m_Vias; // via of the arc from the parent
+                std::vector<uint32_t> m_Stamps;
+                uint32_t m_Epoch = 0;
+                Heap m_Heap;
+
+                bool reached(NodeID id) const { return m_Stamps[id] == m_Epoch; }
+
+                void prepare(size_t nodeCount) {
+                    if (m_Stamps.size() < nodeCount) {
+                        m_Distances.resize(nodeCount);
+                        m_Parents.resize(nodeCount);
+                        m_Vias.resize(nodeCount);
+                        m_Stamps.resize(nodeCount, 0);
+                    }
+
+                    if (++m_Epoch == 0) {
+                        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+                        m_Epoch = 1;
+                    }
+
+                    m_Heap.Reset(nodeCount);
+                }
+
+                void reach(NodeID id, PathWeight distance, NodeID parent, NodeID via) {
+                    m_Stamps[id] = m_Epoch;
+                    m_Distances[id] = distance;
+                    m_Parents[id] = parent;
+                    m_Vias[id] = via;
+                }
+        };
+
+    private:
+        Buffer<size_t> m_UpOffsets = std::vector<size_t>{0};
+        Buffer<Arc> m_UpArcs;
+        Buffer<size_t> m_DownOffsets = std::vector<size_t>{0};
+        Buffer<Arc> m_DownArcs;
+
+    public:
+        ContractionHierarchy() {}
+
+        static ContractionHierarchy Build(const CSRGraph<W> &csr) {
+            return Contractor(csr).Run();
+        }
+
+        static ContractionHierarchy Map(std::span<const size_t> upOffsets,
+                                        std::span<const Arc> upArcs,
+                                        std::span<const size_t> downOffsets,
+                                        std::span<const Arc> downArcs,
+                                        std::shared_ptr<const void> keepAlive) {
+            validate(upOffsets, upArcs);
+            validate(downOffsets, downArcs);
+            if (upOffsets.size() != downOffsets.size())
+                throw(std::invalid_argument("hierarchy directions differ in node count"));
+
+            ContractionHierarchy hierarchy;
+            hierarchy.m_UpOffsets = Buffer<size_t>::Map(upOffsets, keepAlive);
+            hierarchy.m_UpArcs = Buffer<Arc>::Map(upArcs, keepAlive);
+            hierarchy.m_DownOffsets = Buffer<size_t>::Map(downOffsets, keepAlive);
+            hierarchy.m_DownArcs = Buffer<Arc>::Map(downArcs, keepAlive);
+            return hierarchy;
+        }
+
+        size_t NodeCount() const { return m_UpOffsets.size() - 1; }
+        size_t ArcCount() const { return m_UpArcs.size() + m_DownArcs.size(); }
+
+        std::span<const Arc> Up(NodeID u) const { return row(m_UpOffsets, m_UpArcs, u); }
+        std::span<const Arc> Down(NodeID u) const { return row(m_DownOffsets, m_DownArcs, u); }
+
+        std::span<const size_t> UpOffsets() const { return m_UpOffsets.View(); }
+        std::span<const Arc> UpArcs() const { return m_UpArcs.View(); }
+        std::span<const size_t> DownOffsets() const { return m_DownOffsets.View(); }
+        std::span<const Arc> DownArcs() const { return m_DownArcs.View(); }
+
+        static Workspace &LocalWorkspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        static Workspace &LocalReverseWorkspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        // the distance is re-summed over the unpacked edges in path order, so it
+        // matches what a plain Dijkstra run reports for the same path
+        Path Query(NodeID source, NodeID target, Workspace &forward = LocalWorkspace(),
+                   Workspace &backward = LocalReverseWorkspace()) const {
+            if (source == target)
+                return {PathWeight{}, 0, {source}};
+
+            forward.prepare(NodeCount());
+            backward.prepare(NodeCount());
+            forward.reach(source, PathWeight{}, INVALID_NODE, INVALID_NODE);
+            forward.m_Heap.Push(source, PathWeight{});
+            backward.reach(target, PathWeight{}, INVALID_NODE, INVALID_NODE);
+            backward.m_Heap.Push(target, PathWeight{});
+
+            PathWeight best = InfinityOf<PathWeight>();
+            NodeID meeting = INVALID_NODE;
+
+            // a side is done once its frontier cannot improve on the best meeting
+            auto active = [&best](const Workspace &ws) {
+                return !ws.m_Heap.Empty() && ws.m_Heap.Top().second < best;
+            };
+
+            while (active(forward) || active(backward)) {
+                bool up = active(forward) &&
+                          (!active(backward) ||
+                           forward.m_Heap.Top().second <= backward.m_Heap.Top().second);
+
+                if (up)
+                    settle_next(m_UpOffsets, m_UpArcs, forward, backward, best, meeting);
+                else
+                    settle_next(m_DownOffsets, m_DownArcs, backward, forward, best, meeting);
+            }
+
+            Path path;
+            if (meeting == INVALID_NODE)
+                return path;
+
+            std::vector<Arc> arcs; // the path as hierarchy arcs, each oriented forward
+            std::vector<NodeID> starts;
+
+            for (NodeID id = meeting; forward.m_Parents[id] != INVALID_NODE;
+                 id = forward.m_Parents[id]) {
+                starts.push_back(forward.m_Parents[id]);
+                arcs.push_back({id, forward.m_Vias[id], PathWeight{}});
+            }
+
+            std::reverse(starts.begin(), starts.end());
+            std::reverse(arcs.begin(), arcs.end());
+
+            for (NodeID id = meeting; backward.m_Parents[id] != INVALID_NODE;
+                 id = backward.m_Parents[id]) {
+                starts.push_back(id);
+                arcs.push_back({backward.m_Parents[id], backward.m_Vias[id], PathWeight{}});
+            }
+
+            path.distance = PathWeight{};
+            path.nodes = {source};
+            for (size_t i = 0; i < arcs.size(); i++)
+                unpack(starts[i], arcs[i].target, arcs[i].via, path);
+
+            path.hops = (uint32_t)(path.nodes.size() - 1);
+            return path;
+        }
+
+        // heap bytes held by the index, mapped arcs do not count
+        size_t MemoryUsage() const {
+            return m_UpOffsets.MemoryUsage() + m_UpArcs.MemoryUsage() +
+                   m_DownOffsets.MemoryUsage() + m_DownArcs.MemoryUsage();
+        }
+
+    private:
+        static std::span<const Arc> row(const Buffer<size_t> &offsets, const Buffer<Arc> &arcs,
+                                        NodeID u) {
+            return {arcs.data() + offsets[u], offsets[u + 1] - offsets[u]};
+        }
+
+        static void validate(std::span<const size_t> offsets, std::span<const Arc> arcs) {
+            if (offsets.empty() || offsets.front() != 0 || offsets.back() != arcs.size() ||
+                !std::is_sorted(offsets.begin(), offsets.end()))
+                throw(std::invalid_argument("malformed hierarchy rows"));
+
+            for (const Arc &arc : arcs)
+                if (arc.target >= offsets.size() - 1 ||
+                    (arc.via != INVALID_NODE && arc.via >= offsets.size() - 1))
+                    throw(std::out_of_range(std::to_string(arc.target)));
+        }
+
+        static void settle_next(const Buffer<size_t> &offsets, const Buffer<Arc> &arcs,
+                                Workspace &ws, const Workspace &other, PathWeight &best,
+                                NodeID &meeting) {
+            auto [current, distance] = ws.m_Heap.Pop();
+
+            if (other.reached(current) && distance + other.m_Distances[current] < best) {
+                best = distance + other.m_Distances[current];
+                meeting = current;
+            }
+
+            for (const Arc &arc : row(offsets, arcs, current)) {
+                PathWeight candidate = distance + arc.weight;
+                if (!(candidate < InfinityOf<PathWeight>()))
+                    continue;
+
+                if (!ws.reached(arc.target)) {
+                    ws.reach(arc.target, candidate, current, arc.via);
+                    ws.m_Heap.Push(arc.target, candidate);
+                } else if (candidate < ws.m_Distances[arc.target] &&
+                           ws.m_Heap.Contains(arc.target)) {
+                    ws.reach(arc.target, candidate, current, arc.via);
+                    ws.m_Heap.DecreaseKey(arc.target, candidate);
+                }
+            }
+        }
+
+        // finds the arc from -> to, stored as an up arc of the lower of the two
+        // nodes or as a down arc of it
+        const Arc &find_arc(NodeID from, NodeID to) const {
+            for (const Arc &arc : Up(from))
+                if (arc.target == to)
+                    return arc;
+
+            for (const Arc &arc : Down(to))
+                if (arc.target == from)
+                    return arc;
+
+            throw(std::logic_error("hierarchy arc " + std::to_string(from) + " -> " +
+                                   std::to_string(to) + " is missing"));
+        }
+
+        // appends the original edges behind from -> to (from already in path.nodes);
+        // the bypassed node is always lower than both ends, so its own arcs hold the
+        // two halves of a shortcut
+        void unpack(NodeID from, NodeID to, NodeID via, Path &path) const {
+            std::vector<std::pair<NodeID, NodeID>> pending = {{from, to}};
+            std::vector<NodeID> vias = {via};
+
+            while (!pending.empty()) {
+                auto [a, b] = pending.back();
+                NodeID middle = vias.back();
+                pending.pop_back();
+                vias.pop_back();
+
+                if (middle == INVALID_NODE) {
+                    path.distance += find_arc(a, b).weight;
+                    path.nodes.push_back(b);
+                    continue;
+                }
+
+                // the second half goes first, so the first half is unpacked first
+                pending.push_back({middle, b});
+                vias.push_back(find_arc(middle, b).via);
+                pending.push_back({a, middle});
+                vias.push_back(find_arc(a, middle).via);
+            }
+        }
+
+        /**
+         * @brief Contracts a CSRGraph into a hierarchy. The remaining graph is kept as
+         * per-node adjacency lists that only ever hold uncontracted neighbors and at
+         * most one (the lightest) link per neighbor.
+         */
+        class Contractor {
+            private:
+                struct Link {
+                        NodeID node;
+                        NodeID via;
+                        PathWeight weight;
+                };
+
+                struct Shortcut {
+                        NodeID from;
+                        NodeID to;
+                        NodeID via;
+                        PathWeight weight;
+                };
+
+                std::vector<std::vector<Link>> m_Out;
+                std::vector<std::vector<Link>> m_In;
+                std::vector<uint32_t> m_Contracted; // contracted neighbors, for the order
+                std::vector<bool> m_Done;
+
+                // witness search state, epoch-stamped like the SSSP workspaces
+                std::vector<PathWeight> m_Distances;
+                std::vector<uint32_t> m_Stamps;
+                uint32_t m_Epoch = 0;
+                std::vector<std::pair<PathWeight, NodeID>> m_Queue;
+                std::vector<NodeID> m_TargetOf; // v for the out-neighbors of the simulated v
+
+                std::vector<Shortcut> m_Shortcuts; // of the last simulated node
+                bool m_Estimated = false;          // m_Shortcuts was skipped, see simulate
+
+            public:
+                explicit Contractor(const CSRGraph<W> &csr)
+                    : m_Out(csr.NodeCount()), m_In(csr.NodeCount()),
+                      m_Contracted(csr.NodeCount(), 0), m_Done(csr.NodeCount(), false),
+                      m_Distances(csr.NodeCount()), m_Stamps(csr.NodeCount(), 0),
+                      m_TargetOf(csr.NodeCount(), INVALID_NODE) {
+                    for (NodeID u = 0; u < csr.NodeCount(); u++)
+                        for (size_t i = 0; i < csr.Degree(u); i++)
+                            if (csr.Targets(u)[i] != u)
+                                link(u, csr.Targets(u)[i], INVALID_NODE, csr.Weights(u)[i]);
+                }
+
+                ContractionHierarchy Run() {
+                    const size_t nodeCount = m_Out.size();
+                    std::vector<std::vector<Link>> up(nodeCount), down(nodeCount);
+
+                    using Entry = std::pair<int64_t, NodeID>;
+                    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> order;
+                    // the initial order is estimated, exact priorities follow lazily
+                    for (NodeID v = 0; v < nodeCount; v++)
+                        order.push({estimate(v), v});
+
+                    // lazy updates: a node whose priority grew past the next one's
+                    // goes back into the queue instead of being contracted
+                    while (!order.empty()) {
+                        NodeID v = order.top().second;
+                        order.pop();
+
+                        int64_t priority = simulate(v);
+                        if (!order.empty() && priority > order.top().first) {
+                            order.push({priority, v});
+                            continue;
+                        }
+
+                        if (m_Estimated)
+                            simulate(v, true);
+
+                        up[v] = m_Out[v];
+                        down[v] = m_In[v];
+                        contract(v);
+                    }
+
+                    ContractionHierarchy hierarchy;
+                    hierarchy.m_UpOffsets = flatten(up, hierarchy.m_UpArcs);
+                    hierarchy.m_DownOffsets = flatten(down, hierarchy.m_DownArcs);
+                    return hierarchy;
+                }
+
+            private:
+                // keeps the lighter of two parallel links, and every list sorted by weight
+                void link(NodeID from, NodeID to, NodeID via, PathWeight weight) {
+                    auto update = [&](std::vector<Link> &links, NodeID node) {
+                        auto existing =
+                            std::find_if(links.begin(), links.end(),
+                                         [node](const Link &l) { return l.node == node; });
+                        if (existing != links.end()) {
+                            if (!(weight < existing->weight))
+                                return;
+
+                            links.erase(existing);
+                        }
+
+                        auto heavier = std::upper_bound(
+                            links.begin(), links.end(), weight,
+                            [](PathWeight w, const Link &l) { return w < l.weight; });
+                        links.insert(heavier, {node, via, weight});
+                    };
+
+                    update(m_Out[from], to);
+                    update(m_In[to], from);
+                }
+
+                // priority as if every neighbor pair needed a shortcut
+                int64_t estimate(NodeID v) const {
+                    return (int64_t)(m_In[v].size() * m_Out[v].size()) -
+                           (int64_t)(m_In[v].size() + m_Out[v].size()) + m_Contracted[v];
+                }
+
+                // collects the shortcuts contracting v would need into m_Shortcuts and
+                // returns its priority, lower being contracted earlier; past
+                // SIMULATE_LIMIT every neighbor pair is assumed to need one unless `exact`
+                int64_t simulate(NodeID v, bool exact = false) {
+                    const int64_t degree = (int64_t)m_In[v].size() + (int64_t)m_Out[v].size();
+                    const size_t pairs = m_In[v].size() * m_Out[v].size();
+
+                    m_Shortcuts.clear();
+                    m_Estimated = !exact && pairs > SIMULATE_LIMIT;
+                    if (m_Estimated)
+                        return estimate(v);
+
+                    for (const Link &out : m_Out[v])
+                        m_TargetOf[out.node] = v;
+
+                    for (const Link &in : m_In[v]) {
+                        PathWeight limit = PathWeight{};
+                        for (const Link &out : m_Out[v])
+                            if (out.node != in.node)
+                                limit = std::max<PathWeight>(limit, in.weight + out.weight);
+
+                        // shortcuts of InfinityOf<PathWeight>() or more are never added
+                        limit = std::min(limit, InfinityOf<PathWeight>());
+
+                        const size_t targets = m_Out[v].size() - (m_TargetOf[in.node] == v);
+                        if (targets == 0)
+                            continue;
+
+                        witness_search(in.node, v, limit, targets);
+
+                        for (const Link &out : m_Out[v]) {
+                            if (out.node == in.node)
+                                continue;
+
+                            PathWeight weight = in.weight + out.weight;
+                            if (weight < InfinityOf<PathWeight>() &&
+                                !(distance(out.node) <= weight))
+                                m_Shortcuts.push_back({in.node, out.node, v, weight});
+                        }
+                    }
+
+                    for (const Link &out : m_Out[v])
+                        m_TargetOf[out.node] = INVALID_NODE;
+
+                    return (int64_t)m_Shortcuts.size() - degree + m_Contracted[v];
+                }
+
+                void contract(NodeID v) {
+                    for (const Shortcut &shortcut : m_Shortcuts)
+                        link(shortcut.from, shortcut.to, shortcut.via, shortcut.weight);
+
+                    auto drop = [v](std::vector<Link> &links) {
+                        std::erase_if(links, [v](const Link &l) { return l.node == v; });
+                    };
+
+                    for (const Link &in : m_In[v]) {
+                        drop(m_Out[in.node]);
+                        m_Contracted[in.node]++;
+                    }
+
+                    for (const Link &out : m_Out[v]) {
+                        drop(m_In[out.node]);
+                        m_Contracted[out.node]++;
+                    }
+
+                    m_Done[v] = true;
+                    m_Out[v] = {};
+                    m_In[v] = {};
+                }
+
+                PathWeight distance(NodeID id) const {
+                    return m_Stamps[id] == m_Epoch ? m_Distances[id] : InfinityOf<PathWeight>();
+                }
+
+                // Dijkstra from source around `skip`, up to `limit` and WITNESS_LIMIT nodes;
+                // it ends early once the `targets` out-neighbors of skip are all settled
+                void witness_search(NodeID source, NodeID skip, PathWeight limit, size_t targets) {
+                    if (++m_Epoch == 0) {
+                        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+                        m_Epoch = 1;
+                    }
+
+                    auto later = std::greater<std::pair<PathWeight, NodeID>>();
+                    m_Queue.assign(1, {PathWeight{}, source});
+                    m_Stamps[source] = m_Epoch;
+                    m_Distances[source] = PathWeight{};
+
+                    for (size_t settled = 0; !m_Queue.empty() && settled < WITNESS_LIMIT;) {
+                        std::pop_heap(m_Queue.begin(), m_Queue.end(), later);
+                        auto [d, u] = m_Queue.back();
+                        m_Queue.pop_back();
+
+                        if (d > m_Distances[u]) // outdated entry
+                            continue;
+                        if (d > limit)
+                            break;
+                        if (u != source && m_TargetOf[u] == skip && --targets == 0)
+                            break;
+
+                        settled++;
+                        for (const Link &out : m_Out[u]) {
+                            PathWeight candidate = d + out.weight;
+                            if (candidate > limit) // the rest of the list is heavier still
+                                break;
+
+                            if (out.node != skip && candidate < distance(out.node)) {
+                                m_Stamps[out.node] = m_Epoch;
+                                m_Distances[out.node] = candidate;
+                                m_Queue.push_back({candidate, out.node});
+                                std::push_heap(m_Queue.begin(), m_Queue.end(), later);
+                            }
+                        }
+                    }
+                }
+
+                static Buffer<size_t> flatten(const std::vector<std::vector<Link>> &rows,
+                                              Buffer<Arc> &arcs) {
+                    std::vector<size_t> offsets = {0};
+                    std::vector<Arc> flat;
+
+                    for (const std::vector<Link> &links : rows) {
+                        for (const Link &l : links)
+                            flat.push_back({l.node, l.via, l.weight});
+
+                        offsets.push_back(flat.size());
+                    }
+
+                    arcs = std::move(flat);
+                    return offsets;
+                }
+        };
+};
\ No newline at end of file
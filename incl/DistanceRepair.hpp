@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CSRGraph.hpp"
+#include "DistanceTable.hpp"
+#include "Heap.hpp"
+#include "Parallel.hpp"
+#include "ShortestPaths.hpp"
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Keeps a DistanceTable up to date across edge updates instead of
+ * recomputing every source.
+ *
+ * Insert relaxes the new edges into each row they improve and runs Dijkstra only
+ * over the nodes whose distance drops. Remove follows Ramalingam-Reps: a row is
+ * touched only if a removed edge was tight in it, the nodes that lost every tight
+ * in-edge are collected in distance order, and only those are settled again from
+ * their unaffected in-neighbors. Rows are independent, so both run one source per
+ * task. Cells stay ordered by (weight, hops) like the ones from a full run, so a
+ * path of the same weight with fewer edges counts as an improvement too.
+ *
+ * @tparam W edge weight data type, weights must not be negative; the table holds
+ * PathWeightOf<W> sums
+ */
+template <typename W = NodeWeight> class DistanceRepair {
+    private:
+        using CSR = CSRGraph<W>;
+        using PathWeight = PathWeightOf<W>;
+        using Edge = typename CSR::Edge;
+
+        enum State : uint8_t { CANDIDATE, SUPPORTED, AFFECTED, SETTLED };
+
+        // per-thread scratch, validated by an epoch stamp like the SSSP workspace
+        struct Workspace {
+                std::vector<uint32_t> m_Stamps;
+                std::vector<State> m_States;
+                std::vector<NodeID> m_Affected;
+                uint32_t m_Epoch = 0;
+                QuaternaryHeap<PathWeight> m_Heap;
+
+                void prepare(size_t nodeCount) {
+                    if (m_Stamps.size() < nodeCount) {
+                        m_Stamps.resize(nodeCount, 0);
+                        m_States.resize(nodeCount);
+                    }
+
+                    if (++m_Epoch == 0) {
+                        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+                        m_Epoch = 1;
+                    }
+
+                    m_Affected.clear();
+                    m_Heap.Reset(nodeCount);
+                }
+
+                bool Marked(NodeID id, State state) const {
+                    return m_Stamps[id] == m_Epoch && m_States[id] == state;
+                }
+
+                void mark(NodeID id, State state) {
+                    m_Stamps[id] = m_Epoch;
+                    m_States[id] = state;
+                }
+        };
+
+    public:
+        // csr already holds the inserted edges; returns the number of rows that changed
+        static size_t Insert(const CSR &csr, DistanceTable<PathWeight> &table,
+                             std::span<const Edge> inserted, size_t threadCount = 0) {
+            SPA_STAT_PHASE(PHASE_REPAIR);
+            std::atomic<size_t> repaired = 0;
+            table.Unmap();
+
+            ParallelFor(table.NodeCount(), threadCount, [&](size_t source, size_t) {
+                if (insert_row(csr, table.MutableWeightRow((NodeID)source),
+                               table.MutableHopRow((NodeID)source), inserted))
+                    repaired++;
+            }, 64);
+
+            return repaired;
+        }
+
+        // csr no longer holds the removed edges; returns the number of rows that changed
+        static size_t Remove(const CSR &csr, DistanceTable<PathWeight> &table,
+                             std::span<const Edge> removed, size_t threadCount = 0) {
+            SPA_STAT_PHASE(PHASE_REPAIR);
+            const CSR reverse = csr.Transpose();
+            std::atomic<size_t> repaired = 0;
+            table.Unmap();
+
+            // the affected set is only exact if every tight edge leads to a farther node
+            const bool positive = std::all_of(csr.Weights().begin(), csr.Weights().end(),
+                                              [](W weight) { return weight > W{}; });
+
+            ParallelFor(table.NodeCount(), threadCount, [&](size_t source, size_t) {
+                std::span<PathWeight> weights = table.MutableWeightRow((NodeID)source);
+                std::span<uint32_t> hops = table.MutableHopRow((NodeID)source);
+
+                if (positive ? remove_row(csr, reverse, weights, hops, removed)
+                             : recompute_row(csr, (NodeID)source, weights, hops, removed))
+                    repaired++;
+            }, 64);
+
+            return repaired;
+        }
+
+    private:
+        static Workspace &local_workspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        static bool reachable(std::span<const uint32_t> hops, NodeID id) {
+            return hops[id] != InfinityOf<uint32_t>();
+        }
+
+        // the removed edge carried a shortest path into its target
+        static bool tight(std::span<const PathWeight> weights, std::span<const uint32_t> hops,
+                          const Edge &edge) {
+            return reachable(hops, edge.from) &&
+                   weights[edge.from] + edge.weight == weights[edge.to];
+        }
+
+        static bool insert_row(const CSR &csr, std::span<PathWeight> weights,
+                               std::span<uint32_t> hops, std::span<const Edge> inserted) {
+            Workspace *ws = nullptr;
+
+            for (const Edge &edge : inserted) {
+                if (!reachable(hops, edge.from) ||
+                    !improves(weights[edge.from] + edge.weight, hops[edge.from] + 1,
+                              weights[edge.to], hops[edge.to]))
+                    continue;
+
+                if (ws == nullptr) {
+                    ws = &local_workspace();
+                    ws->prepare(weights.size());
+                }
+
+                relax(ws, weights, hops, edge.from, edge.to, edge.weight);
+            }
+
+            if (ws == nullptr)
+                return false;
+
+            // the improvement spreads only through nodes that it improves in turn
+            while (!ws->m_Heap.Empty()) {
+                NodeID current = ws->m_Heap.Pop().first;
+                std::span<const NodeID> targets = csr.Targets(current);
+                std::span<const W> edgeWeights = csr.Weights(current);
+
+                for (size_t i = 0; i < targets.size(); i++)
+                    relax(ws, weights, hops, current, targets[i], edgeWeights[i]);
+            }
+
+            return true;
+        }
+
+        static bool remove_row(const CSR &csr, const CSR &reverse, std::span<PathWeight> weights,
+                               std::span<uint32_t> hops, std::span<const Edge> removed) {
+            Workspace *ws = nullptr;
+
+            for (const Edge &edge : removed) {
+                if (!tight(weights, hops, edge))
+                    continue;
+
+                if (ws == nullptr) {
+                    ws = &local_workspace();
+                    ws->prepare(weights.size());
+                }
+
+                if (!ws->m_Heap.Contains(edge.to)) {
+                    ws->mark(edge.to, CANDIDATE);
+                    ws->m_Heap.Push(edge.to, weights[edge.to]);
+                }
+            }
+
+            if (ws == nullptr)
+                return false;
+
+            // phase 1: candidates leave by old distance, so every in-neighbor that
+            // could still support one has already been classified
+            while (!ws->m_Heap.Empty()) {
+                NodeID current = ws->m_Heap.Pop().first;
+                std::span<const NodeID> sources = reverse.Targets(current);
+                std::span<const W> inWeights = reverse.Weights(current);
+                bool supported = false;
+
+                for (size_t i = 0; i < sources.size() && !supported; i++)
+                    supported = reachable(hops, sources[i]) &&
+                                !ws->Marked(sources[i], AFFECTED) &&
+                                weights[sources[i]] + inWeights[i] == weights[current] &&
+                                hops[sources[i]] + 1 == hops[current];
+
+                if (supported) {
+                    ws->mark(current, SUPPORTED);
+                    continue;
+                }
+
+                ws->mark(current, AFFECTED);
+                ws->m_Affected.push_back(current);
+
+                std::span<const NodeID> targets = csr.Targets(current);
+                std::span<const W> edgeWeights = csr.Weights(current);
+                for (size_t i = 0; i < targets.size(); i++) {
+                    NodeID next = targets[i];
+                    if (ws->m_Stamps[next] != ws->m_Epoch &&
+                        weights[current] + edgeWeights[i] == weights[next]) {
+                        ws->mark(next, CANDIDATE);
+                        ws->m_Heap.Push(next, weights[next]);
+                    }
+                }
+            }
+
+            for (NodeID id : ws->m_Affected) {
+                weights[id] = InfinityOf<PathWeight>();
+                hops[id] = InfinityOf<uint32_t>();
+            }
+
+            // phase 2: seed the affected nodes from their unaffected in-neighbors and
+            // settle them again, preferring fewer hops between equal weights
+            for (NodeID id : ws->m_Affected) {
+                std::span<const NodeID> sources = reverse.Targets(id);
+                std::span<const W> inWeights = reverse.Weights(id);
+
+                for (size_t i = 0; i < sources.size(); i++)
+                    if (reachable(hops, sources[i]) && !ws->Marked(sources[i], AFFECTED))
+                        relax(ws, weights, hops, sources[i], id, inWeights[i]);
+            }
+
+            while (!ws->m_Heap.Empty()) {
+                NodeID current = ws->m_Heap.Pop().first;
+                ws->mark(current, SETTLED);
+
+                std::span<const NodeID> targets = csr.Targets(current);
+                std::span<const W> edgeWeights = csr.Weights(current);
+                for (size_t i = 0; i < targets.size(); i++)
+                    if (ws->Marked(targets[i], AFFECTED))
+                        relax(ws, weights, hops, current, targets[i], edgeWeights[i]);
+            }
+
+            return true;
+        }
+
+        // zero-weight edges break the distance order phase 1 relies on, so such
+        // graphs recompute each row that lost a tight edge in full
+        static bool recompute_row(const CSR &csr, NodeID source, std::span<PathWeight> weights,
+                                  std::span<uint32_t> hops, std::span<const Edge> removed) {
+            if (std::none_of(removed.begin(), removed.end(),
+                             [&](const Edge &edge) { return tight(weights, hops, edge); }))
+                return false;
+
+            const typename ShortestPaths<W>::Workspace &run = ShortestPaths<W>::Run(csr, source);
+            std::fill(weights.begin(), weights.end(), InfinityOf<PathWeight>());
+            std::fill(hops.begin(), hops.end(), InfinityOf<uint32_t>());
+
+            for (NodeID id : run.Settled()) {
+                weights[id] = run.Distance(id);
+                hops[id] = run.Hops(id);
+            }
+
+            return true;
+        }
+
+        // (candidate, candidateHops) comes before (weight, hop) and is reachable
+        static bool improves(PathWeight candidate, uint32_t candidateHops, PathWeight weight,
+                             uint32_t hop) {
+            return candidate < InfinityOf<PathWeight>() &&
+                   (candidate < weight || (candidate == weight && candidateHops < hop));
+        }
+
+        static void relax(Workspace *ws, std::span<PathWeight> weights, std::span<uint32_t> hops,
+                          NodeID from, NodeID to, W weight) {
+            PathWeight candidate = weights[from] + weight;
+            uint32_t candidateHops = hops[from] + 1;
+
+            if (improves(candidate, candidateHops, weights[to], hops[to])) {
+                weights[to] = candidate;
+                hops[to] = candidateHops;
+                push_or_decrease(ws->m_Heap, to, candidate);
+            }
+        }
+
+        static void push_or_decrease(QuaternaryHeap<PathWeight> &heap, NodeID id, PathWeight key) {
+            if (heap.Contains(id))
+                heap.DecreaseKey(id, key);
+            else
+                heap.Push(id, key);
+        }
+};
\ No newline at end of file
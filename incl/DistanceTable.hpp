@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Dense all-pairs result table: row `source` holds, for every target, the
+ * shortest-path weight and the fewest edges among the paths of that weight, i.e.
+ * the (weight, hops) minimum; INF (resp. InfinityOf<uint32_t>) if unreachable.
+ * Both arrays are row-major V x V, so the storage can be written and mapped back
+ * from a snapshot as-is.
+ *
+ * @tparam W path weight data type
+ */
+template <typename W = NodeWeight> class DistanceTable {
+    private:
+        size_t m_NodeCount = 0;
+        Buffer<W> m_Weights;
+        Buffer<uint32_t> m_Hops;
+
+    public:
+        DistanceTable() {}
+
+        // every cell starts out unreachable
+        explicit DistanceTable(size_t nodeCount) : m_NodeCount(nodeCount) {
+            m_Weights = std::vector<W>(nodeCount * nodeCount, InfinityOf<W>());
+            m_Hops = std::vector<uint32_t>(nodeCount * nodeCount, InfinityOf<uint32_t>());
+            SPA_STAT_ADD(bytesAllocated, MemoryUsage());
+        }
+
+        static DistanceTable Map(size_t nodeCount, std::span<const W> weights,
+                                 std::span<const uint32_t> hops,
+                                 std::shared_ptr<const void> keepAlive) {
+            if (weights.size() != nodeCount * nodeCount || hops.size() != weights.size())
+                throw(std::invalid_argument("malformed distance table"));
+
+            DistanceTable table;
+            table.m_NodeCount = nodeCount;
+            table.m_Weights = Buffer<W>::Map(weights, keepAlive);
+            table.m_Hops = Buffer<uint32_t>::Map(hops, keepAlive);
+            return table;
+        }
+
+        // grows the table to nodeCount nodes, keeping the existing cells; a new node
+        // only reaches itself until edges are repaired in
+        void Resize(size_t nodeCount) {
+            if (nodeCount == m_NodeCount)
+                return;
+
+            DistanceTable table(nodeCount);
+            const size_t common = std::min(nodeCount, m_NodeCount);
+
+            for (NodeID source = 0; source < common; source++) {
+                std::copy_n(WeightRow(source).begin(), common,
+                            table.MutableWeightRow(source).begin());
+                std::copy_n(HopRow(source).begin(), common, table.MutableHopRow(source).begin());
+            }
+
+            for (NodeID node = (NodeID)common; node < nodeCount; node++) {
+                table.MutableWeightRow(node)[node] = W{};
+                table.MutableHopRow(node)[node] = 0;
+            }
+
+            *this = std::move(table);
+        }
+
+        // copies a mapped table into owned memory, after which distinct rows can be
+        // written from different threads
+        void Unmap() {
+            m_Weights.Owned();
+            m_Hops.Owned();
+        }
+
+        bool Empty() const { return m_NodeCount == 0; }
+        size_t NodeCount() const { return m_NodeCount; }
+        bool IsMapped() const { return m_Weights.IsMapped(); }
+
+        W Weight(NodeID source, NodeID target) const {
+            return m_Weights[(size_t)source * m_NodeCount + target];
+        }
+
+        uint32_t Hops(NodeID source, NodeID target) const {
+            return m_Hops[(size_t)source * m_NodeCount + target];
+        }
+
+        bool Reachable(NodeID source, NodeID target) const {
+            return Hops(source, target) != InfinityOf<uint32_t>();
+        }
+
+        std::span<const W> WeightRow(NodeID source) const {
+            return m_Weights.View().subspan((size_t)source * m_NodeCount, m_NodeCount);
+        }
+
+        std::span<const uint32_t> HopRow(NodeID source) const {
+            return m_Hops.View().subspan((size_t)source * m_NodeCount, m_NodeCount);
+        }
+
+        // writable rows; distinct rows may be filled from different threads
+        std::span<W> MutableWeightRow(NodeID source) {
+            return std::span<W>(m_Weights.Owned()).subspan((size_t)source * m_NodeCount,
+                                                            m_NodeCount);
+        }
+
+        std::span<uint32_t> MutableHopRow(NodeID source) {
+            return std::span<uint32_t>(m_Hops.Owned())
+                .subspan((size_t)source * m_NodeCount, m_NodeCount);
+        }
+
+        std::span<const W> Weights() const { return m_Weights.View(); }
+        std::span<const uint32_t> Hops() const { return m_Hops.View(); }
+
+        size_t MemoryUsage() const { return m_Weights.MemoryUsage() + m_Hops.MemoryUsage(); }
+};
\ No newline at end of file
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "CSRGraph.hpp"
+#include "DistanceTable.hpp"
+#include "Parallel.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Cache-blocked Floyd-Warshall filling a DistanceTable in place.
+ *
+ * The V x V table is cut into TILE x TILE tiles. Each round k first closes the
+ * diagonal tile (k, k), then the tiles in row k and column k, which only depend on
+ * it, and finally every remaining tile, which depends only on row k and column k;
+ * the tiles of the last two phases are independent and run in parallel.
+ *
+ * The innermost loop is the min-plus update of one tile row, vectorized with
+ * AVX-512 or AVX2 for double weights when the build enables them (-mavx512f
+ * -mavx512vl, -mavx2) and scalar otherwise. Hop counts ride along: a lighter
+ * path replaces both, a path of the same weight only the hop count if it has
+ * fewer edges, so cells end up ordered by (weight, hops) like a ShortestPaths run.
+ * Costs O(V^3) regardless of the edge count, which pays off for dense graphs only.
+ *
+ * @tparam W edge weight data type, weights must not be negative; the table holds
+ * PathWeightOf<W> sums
+ */
+template <typename W = NodeWeight> class FloydWarshall {
+    public:
+        using PathWeight = PathWeightOf<W>;
+
+        // 64 x 64 tiles of weights and hops take 48 KiB for doubles, three of them
+        // (the tile and its row/column sources) stay within a typical L2 cache
+        static constexpr size_t TILE = 64;
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+        static constexpr bool VECTORIZED = std::is_same_v<PathWeight, double>;
+#else
+        static constexpr bool VECTORIZED = false;
+#endif
+
+        // Dijkstra from every source costs O(V E log V), so the cubic sweep wins
+        // once the graph is dense enough; the ratios were measured on random graphs
+        static bool Preferred(size_t nodeCount, size_t edgeCount) {
+            return edgeCount * (VECTORIZED ? 8 : 3) >= nodeCount * nodeCount;
+        }
+
+        static DistanceTable<PathWeight> Run(const CSRGraph<W> &csr, size_t threadCount = 0) {
+            const size_t n = csr.NodeCount();
+            DistanceTable<PathWeight> table(n);
+
+            // the direct edges, the lighter one wins for parallel edges
+            for (NodeID u = 0; u < n; u++) {
+                std::span<PathWeight> weights = table.MutableWeightRow(u);
+                std::span<uint32_t> hops = table.MutableHopRow(u);
+                std::span<const NodeID> targets = csr.Targets(u);
+                std::span<const W> edgeWeights = csr.Weights(u);
+
+                for (size_t i = 0; i < targets.size(); i++)
+                    if (edgeWeights[i] < weights[targets[i]]) {
+                        weights[targets[i]] = edgeWeights[i];
+                        hops[targets[i]] = 1;
+                    }
+
+                weights[u] = PathWeight{};
+                hops[u] = 0;
+            }
+
+            PathWeight *weights = table.MutableWeightRow(0).data();
+            uint32_t *hops = table.MutableHopRow(0).data();
+            const size_t tiles = (n + TILE - 1) / TILE;
+
+            // two loops per round on the shared WorkerPool, whose threads persist, so a
+            // round costs two wake-ups rather than starting threads
+            for (size_t k = 0; k < tiles; k++) {
+                update_tile(weights, hops, n, k, k, k);
+
+                ParallelFor(2 * tiles, threadCount, [&](size_t idx, size_t) {
+                    size_t other = idx / 2;
+                    if (other == k)
+                        return;
+
+                    if (idx % 2 == 0)
+                        update_tile(weights, hops, n, k, other, k);
+                    else
+                        update_tile(weights, hops, n, other, k, k);
+                });
+
+                ParallelFor(tiles * tiles, threadCount, [&](size_t idx, size_t) {
+                    size_t row = idx / tiles, col = idx % tiles;
+                    if (row != k && col != k)
+                        update_tile(weights, hops, n, row, col, k);
+                });
+            }
+
+            return table;
+        }
+
+    private:
+        // relaxes tile (row, col) through every node of tile k
+        static void update_tile(PathWeight *weights, uint32_t *hops, size_t n, size_t row,
+                                size_t col, size_t k) {
+            const size_t rowBegin = row * TILE, rowEnd = std::min(n, (row + 1) * TILE);
+            const size_t colBegin = col * TILE, colEnd = std::min(n, (col + 1) * TILE);
+            const size_t kBegin = k * TILE, kEnd = std::min(n, (k + 1) * TILE);
+
+            auto relax = [&](size_t i, size_t via) {
+                const PathWeight head = weights[i * n + via];
+                if (head < InfinityOf<PathWeight>())
+                    relax_row(weights + i * n + colBegin, hops + i * n + colBegin,
+                              weights + via * n + colBegin, hops + via * n + colBegin, head,
+                              hops[i * n + via], colEnd - colBegin);
+            };
+
+            if (row == k || col == k) {
+                // the tile feeds itself, so every intermediate node has to finish first
+                for (size_t via = kBegin; via < kEnd; via++)
+                    for (size_t i = rowBegin; i < rowEnd; i++)
+                        relax(i, via);
+            } else {
+                // the sources are final, so each destination row can take all of
+                // them in one go
+                for (size_t i = rowBegin; i < rowEnd; i++)
+                    if (!relax_through(weights + i * n, hops + i * n, weights, hops, n, colBegin,
+                                       colEnd, kBegin, kEnd))
+                        for (size_t via = kBegin; via < kEnd; via++)
+                            relax(i, via);
+            }
+        }
+
+        // register-blocked update of row[colBegin, colEnd) through the rows
+        // [kBegin, kEnd): the destination stays in registers across all of them.
+        // Returns false if there is no vector kernel for this W / build, which leaves
+        // every parameter unused.
+        static bool relax_through([[maybe_unused]] PathWeight *row,
+                                  [[maybe_unused]] uint32_t *rowHops,
+                                  [[maybe_unused]] const PathWeight *weights,
+                                  [[maybe_unused]] const uint32_t *hops, [[maybe_unused]] size_t n,
+                                  [[maybe_unused]] size_t colBegin, [[maybe_unused]] size_t colEnd,
+                                  [[maybe_unused]] size_t kBegin, [[maybe_unused]] size_t kEnd) {
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+            if constexpr (std::is_same_v<PathWeight, double>) {
+                constexpr size_t LANES = 8, BLOCK = 4; // 32 columns per pass
+                if ((colEnd - colBegin) % (LANES * BLOCK) != 0)
+                    return false;
+
+                for (size_t col = colBegin; col < colEnd; col += LANES * BLOCK) {
+                    __m512d best[BLOCK];
+                    __m256i bestHops[BLOCK];
+                    for (size_t b = 0; b < BLOCK; b++) {
+                        best[b] = _mm512_loadu_pd(row + col + b * LANES);
+                        bestHops[b] =
+                            _mm256_loadu_si256((const __m256i *)(rowHops + col + b * LANES));
+                    }
+
+                    for (size_t via = kBegin; via < kEnd; via++) {
+                        const PathWeight head = row[via];
+                        if (!(head < InfinityOf<PathWeight>()))
+                            continue;
+
+                        const __m512d heads = _mm512_set1_pd(head);
+                        const __m256i headHops = _mm256_set1_epi32((int)rowHops[via]);
+                        const PathWeight *viaRow = weights + via * n + col;
+                        const uint32_t *viaHops = hops + via * n + col;
+
+                        for (size_t b = 0; b < BLOCK; b++) {
+                            __m512d candidate =
+                                _mm512_add_pd(heads, _mm512_loadu_pd(viaRow + b * LANES));
+                            __m256i candidateHops = _mm256_add_epi32(
+                                headHops,
+                                _mm256_loadu_si256((const __m256i *)(viaHops + b * LANES)));
+
+                            __mmask8 better = _mm512_cmp_pd_mask(candidate, best[b], _CMP_LT_OQ);
+                            __mmask8 fewer = tied_fewer(candidate, best[b], candidateHops,
+                                                        bestHops[b]);
+                            best[b] = _mm512_mask_mov_pd(best[b], better, candidate);
+                            bestHops[b] =
+                                _mm256_mask_mov_epi32(bestHops[b], better | fewer, candidateHops);
+                        }
+                    }
+
+                    for (size_t b = 0; b < BLOCK; b++) {
+                        _mm512_storeu_pd(row + col + b * LANES, best[b]);
+                        _mm256_storeu_si256((__m256i *)(rowHops + col + b * LANES), bestHops[b]);
+                    }
+                }
+
+                return true;
+            }
+#endif
+            return false;
+        }
+
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+        // lanes where candidate is a reachable path of the current weight with fewer hops
+        static __mmask8 tied_fewer(__m512d candidate, __m512d current, __m256i candidateHops,
+                                   __m256i currentHops) {
+            __mmask8 tied = _mm512_cmp_pd_mask(candidate, current, _CMP_EQ_OQ) &
+                            _mm512_cmp_pd_mask(candidate, _mm512_set1_pd(InfinityOf<double>()),
+                                               _CMP_LT_OQ);
+            return _mm256_mask_cmplt_epu32_mask(tied, candidateHops, currentHops);
+        }
+#endif
+
+        // dst[j] = min(dst[j], head + via[j]) over count cells by (weight, hops)
+        static void relax_row(PathWeight *dst, uint32_t *dstHops, const PathWeight *via,
+                              const uint32_t *viaHops, PathWeight head, uint32_t headHops,
+                              size_t count) {
+            size_t j = 0;
+
+            if constexpr (std::is_same_v<PathWeight, double>) {
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+                const __m512d heads = _mm512_set1_pd(head);
+                const __m256i headHopsV = _mm256_set1_epi32((int)headHops);
+
+                for (; j + 8 <= count; j += 8) {
+                    __m512d current = _mm512_loadu_pd(dst + j);
+                    __m512d candidate = _mm512_add_pd(heads, _mm512_loadu_pd(via + j));
+                    __m256i candidateHops = _mm256_add_epi32(
+                        headHopsV, _mm256_loadu_si256((const __m256i *)(viaHops + j)));
+
+                    __mmask8 better = _mm512_cmp_pd_mask(candidate, current, _CMP_LT_OQ);
+                    __mmask8 fewer =
+                        tied_fewer(candidate, current, candidateHops,
+                                   _mm256_loadu_si256((const __m256i *)(dstHops + j)));
+
+                    _mm512_mask_storeu_pd(dst + j, better, candidate);
+                    _mm256_mask_storeu_epi32(dstHops + j, better | fewer, candidateHops);
+                }
+#elif defined(__AVX2__)
+                const __m256d heads = _mm256_set1_pd(head);
+                const __m256d infinity = _mm256_set1_pd(InfinityOf<double>());
+                const __m128i headHopsV = _mm_set1_epi32((int)headHops);
+                // low halves of the four 64-bit compare lanes
+                const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+
+                for (; j + 4 <= count; j += 4) {
+                    __m256d current = _mm256_loadu_pd(dst + j);
+                    __m256d candidate = _mm256_add_pd(heads, _mm256_loadu_pd(via + j));
+                    __m256d better = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+                    __m256d tied = _mm256_and_pd(_mm256_cmp_pd(candidate, current, _CMP_EQ_OQ),
+                                                 _mm256_cmp_pd(candidate, infinity, _CMP_LT_OQ));
+                    _mm256_storeu_pd(dst + j, _mm256_blendv_pd(current, candidate, better));
+
+                    __m128i currentHops = _mm_loadu_si128((const __m128i *)(dstHops + j));
+                    __m128i candidateHops =
+                        _mm_add_epi32(headHopsV, _mm_loadu_si128((const __m128i *)(viaHops + j)));
+
+                    __m128i betterMask = _mm256_castsi256_si128(
+                        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(better), pack));
+                    __m128i tiedMask = _mm256_castsi256_si128(
+                        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(tied), pack));
+
+                    // unsigned candidateHops >= currentHops
+                    __m128i notFewer =
+                        _mm_cmpeq_epi32(_mm_max_epu32(candidateHops, currentHops), candidateHops);
+                    __m128i mask = _mm_or_si128(betterMask, _mm_andnot_si128(notFewer, tiedMask));
+                    _mm_storeu_si128((__m128i *)(dstHops + j),
+                                     _mm_blendv_epi8(currentHops, candidateHops, mask));
+                }
+#endif
+            }
+
+            for (; j < count; j++) {
+                PathWeight candidate = head + via[j];
+                if (candidate < dst[j]) {
+                    dst[j] = candidate;
+                    dstHops[j] = headHops + viaHops[j];
+                } else if (candidate == dst[j] && candidate < InfinityOf<PathWeight>() &&
+                           headHops + viaHops[j] < dstHops[j]) {
+                    dstHops[j] = headHops + viaHops[j];
+                }
+            }
+        }
+};
\ No newline at end of file
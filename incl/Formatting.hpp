@@ -0,0 +1,40 @@
+#pragma once
+
+#include <charconv>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Appends a number with a fixed count of decimals, without going through a
+ * locale or a temporary string.
+ */
+template <typename N> void AppendFixed(std::string &out, N value, int precision) {
+    char number[64];
+    auto [end, error] = std::to_chars(number, number + sizeof(number), value,
+                                      std::chars_format::fixed, precision);
+
+    if (error == std::errc())
+        out.append(number, end);
+    else // only absurdly large values do not fit
+        out += std::to_string(value);
+}
+
+/**
+ * @brief Appends a node payload: strings are copied, arithmetic payloads are
+ * printed with to_chars, anything else goes through its operator<<. The inverse
+ * of ParseSymbol.
+ */
+template <typename T> void AppendSymbol(std::string &out, const T &value) {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        out += std::string_view(value);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        char number[64];
+        out.append(number, std::to_chars(number, number + sizeof(number), value).ptr);
+    } else {
+        std::ostringstream stream;
+        stream << value;
+        out += stream.str();
+    }
+}
\ No newline at end of file
@@ -1,200 +1,330 @@
 #pragma once
 
+#include "BitParallelBFS.hpp"
+#include "CSRGraph.hpp"
+#include "ContractionHierarchy.hpp"
+#include "DistanceRepair.hpp"
+#include "DistanceTable.hpp"
+#include "FloydWarshall.hpp"
+#include "Formatting.hpp"
 #include "Matrix.hpp"
+#include "MappedFile.hpp"
 #include "Node.hpp"
+#include "Parallel.hpp"
+#include "Parsing.hpp"
 #include "Relation.hpp"
+#include "ShortestPaths.hpp"
+#include "Snapshot.hpp"
+#include "SourceCache.hpp"
+#include "Stats.hpp"
+#include "SymbolTable.hpp"
+#include "TopKTable.hpp"
+#include "Traversal.hpp"
 #include "literals.hpp"
 
 #include <algorithm>
 #include <climits>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <initializer_list>
 #include <limits>
 #include <list>
 #include <map>
 #include <numeric>
 #include <queue>
-#include <regex>
 #include <set>
-#include <stack>
+#include <span>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-template <typename T> class Graph {
+// how InitDistances fills the all-pairs table
+enum AllPairsMethod {
+    ALL_PAIRS_AUTO = 0,       // Floyd-Warshall for dense static graphs, Dijkstra otherwise
+    ALL_PAIRS_DIJKSTRA,       // one Dijkstra run per source
+    ALL_PAIRS_FLOYD_WARSHALL, // blocked Floyd-Warshall, see FloydWarshall.hpp
+};
+
+/**
+ * @brief Word-association graph over node payloads of type T.
+ *
+ * @tparam T node payload data type
+ * @tparam W edge weight data type. Integer types hold fixed-point scores (see
+ * ToWeight): file weights are scaled on load and printed back as scores, while
+ * the query API deals in raw W. A uint16_t weight takes a quarter of a double
+ * in the adjacency, and searches switch to a radix heap (see DefaultHeap).
+ * Distances are PathWeightOf<W>, so paths outgrow the edge type without saturating.
+ */
+template <typename T, typename W = NodeWeight> class Graph {
     private:
-        using NodeSet = std::multiset<std::pair<Node<T>, NodeWeight>>;
-        using NodeWeight = double;
+        using CSR = CSRGraph<W>;
+        using Edge = typename CSR::Edge;
+        using SSSP = ShortestPaths<W>;
+        using Repair = DistanceRepair<W>;
+        using Cache = SourceCache<PathWeightOf<W>>;
+        using Hierarchy = ContractionHierarchy<W>;
+        using Walk = Traversal<W>;
+
+    public:
+        // how node payloads are handed out: std::string_view for string graphs, T otherwise
+        using Symbol = typename SymbolTable<T>::Symbol;
+
+        using PathWeight = PathWeightOf<W>;
+
+        // see ShortestPath
+        struct Path {
+                PathWeight distance = InfinityOf<PathWeight>();
+                uint32_t hops = InfinityOf<uint32_t>();
+                std::vector<Node<T>> nodes;
+        };
 
     private:
-        std::unordered_set<Node<T>, NodeHash<T>> m_Nodes;
-        std::unordered_map<Node<T>, NodeSet, NodeHash<T>> m_Connectivity;
-        NodeWeight m_TotalWeight = 0.0;
+        // nodes are interned into dense IDs, the adjacency itself lives in m_CSR;
+        // Connect only appends to m_PendingEdges, which are folded in lazily by freeze()
+        SymbolTable<T> m_Symbols;
+        mutable CSR m_CSR;
+        mutable CSR m_Reverse; // transpose of m_CSR for backward searches, built on demand
+        mutable Hierarchy m_Hierarchy; // optional, see BuildHierarchy
+        mutable std::vector<Edge> m_PendingEdges;
+        W m_TotalWeight = W{};
 
-        Matrix<NodeWeight> m_AdjMatrix;
-        std::vector<std::string> m_NodeNames;
-        std::unordered_map<Node<T>, bool, NodeHash<T>> m_Visited;
-        std::vector<std::pair<Node<T>, int32_t>> m_Indices;
+        // all-pairs weights and hop counts, filled by InitDistances
+        DistanceTable<PathWeight> m_Distances;
 
-        // NodeSet is always sorted ascendingly
-        std::unordered_map<Node<T>, NodeSet, NodeHash<T>> m_EdgeDistances;
-        std::unordered_map<Node<T>, NodeSet, NodeHash<T>> m_WeightDistances;
+        // all-pairs fewest-edge counts, filled by init_edge_distances and dropped by
+        // every change of the adjacency
+        mutable HopTable m_HopDistances;
+
+        // the nearest targets of every node as DumpData lists them, see GetNearestTable
+        mutable TopKTable<PathWeight> m_Nearest;
+
+        // single-source query results, kept only until the adjacency changes
+        Cache m_Cache;
 
-        bool m_edges_initialized = false;
         bool m_weights_initialized = false;
+        bool m_Dynamic = false;
+        size_t m_ThreadCount = 0; // 0 = one worker per hardware thread
+        AllPairsMethod m_AllPairsMethod = ALL_PAIRS_AUTO;
         std::string m_Filename;
         std::string m_OutDir = ".\\out\\";
 
     public:
-        void InitDistances() { // using Dijkstra algorithm
-            for (const auto &node : m_Nodes)
-                auto _ = Dijkstra(node);
+        void InitDistances() {
+            SPA_STAT_PHASE(PHASE_DISTANCES);
+            const CSR &csr = freeze();
+
+            // dynamic mode repairs rely on every weight being the exact sum of its
+            // path's edges in path order, which only Dijkstra guarantees for doubles
+            if (m_AllPairsMethod == ALL_PAIRS_FLOYD_WARSHALL ||
+                (m_AllPairsMethod == ALL_PAIRS_AUTO && !m_Dynamic &&
+                 FloydWarshall<W>::Preferred(csr.NodeCount(), csr.EdgeCount()))) {
+                m_Distances = FloydWarshall<W>::Run(csr, m_ThreadCount);
+            } else { // using Dijkstra algorithm, one source per task
+                // the table is allocated up front, every source then owns its own row
+                DistanceTable<PathWeight> table(csr.NodeCount());
+
+                // each worker runs in its own thread-local SSSP workspace
+                ParallelFor(csr.NodeCount(), m_ThreadCount, [&](size_t id, size_t) {
+                    const typename SSSP::Workspace &ws = SSSP::Run(csr, (NodeID)id);
+                    store_distances(ws, table.MutableWeightRow((NodeID)id),
+                                    table.MutableHopRow((NodeID)id));
+                });
+
+                m_Distances = std::move(table);
+            }
 
-            m_edges_initialized = m_weights_initialized = true;
+            m_weights_initialized = true;
         }
 
+        void SetAllPairsMethod(AllPairsMethod method) { m_AllPairsMethod = method; }
+        AllPairsMethod GetAllPairsMethod() const { return m_AllPairsMethod; }
+
+        // directory DumpData writes into, including the trailing separator
+        void SetOutDir(const std::string &outDir) { m_OutDir = outDir; }
+
+        // worker count used by the all-sources precompute, 0 = hardware concurrency
+        void SetThreadCount(size_t threadCount) { m_ThreadCount = threadCount; }
+        size_t GetThreadCount() const { return ResolveThreadCount(m_ThreadCount); }
+
+        // in dynamic mode edge updates repair the affected rows of an already
+        // computed distance table instead of discarding it (see DistanceRepair)
+        void SetDynamic(bool dynamic) { m_Dynamic = dynamic; }
+        bool IsDynamic() const { return m_Dynamic; }
+
         Graph() {}
 
         // initialize a graph with specified nodes
-        Graph(std::initializer_list<std::pair<T, uint8_t>> nodes) {
-            for (auto [nodeData, nodeId] : nodes) {
-                Node<T> node(nodeData, nodeId);
-                m_Nodes.emplace(node);
-                m_Connectivity[node];
-            }
+        Graph(std::initializer_list<Node<T>> nodes) {
+            for (auto node : nodes)
+                m_Symbols.Intern(node.GetData());
         }
 
-        Graph(std::initializer_list<Node<T>> nodes) {
-            for (auto node : nodes) {
-                m_Nodes.emplace(node);
-                m_Connectivity[node];
-            }
+        // nodes in ID order, i.e. GetNodes()[id] is the payload of node `id`
+        std::span<const Symbol> GetNodes() const { return m_Symbols.Symbols(); }
+
+        const size_t NodeCount() const { return m_Symbols.Size(); }
+        size_t NodeCount() { return m_Symbols.Size(); }
+
+        // returns INVALID_NODE for unknown nodes
+        NodeID IdOf(const T &data) const { return m_Symbols.Find(data); }
+        decltype(auto) DataOf(NodeID id) const { return m_Symbols.Get(id); }
+
+        const CSR &GetCSR() const { return freeze(); }
+
+        // builds what the read-only queries otherwise build on first use, i.e. the CSR
+        // and its transpose; afterwards KNearest, ShortestPath, Dijkstra and DFS may be
+        // called from several threads at once, as long as the graph does not change
+        void PrepareQueries() const { reverse(); }
+
+        // all-pairs weights and hop counts, computed first if needed
+        const DistanceTable<PathWeight> &GetDistances() {
+            init_weights();
+            return m_Distances;
         }
 
-        decltype(m_Nodes) &GetNodes() { return m_Nodes; }
-        const decltype(m_Nodes) &GetNodes() const { return m_Nodes; }
+        // the k targets nearest to every node by (weight, hops, ID), as DumpData lists
+        // them; read off the all-pairs table if one is computed, otherwise filled
+        // by bounded searches, so the V x V table is never allocated for it
+        const TopKTable<PathWeight> &GetNearestTable(size_t k = DUMP_LIMIT) {
+            init_nearest(k);
+            return m_Nearest;
+        }
+
+        // all-pairs fewest-edge counts, which printEdgeDistances shows
+        const HopTable &GetHopDistances() {
+            init_edge_distances();
+            return m_HopDistances;
+        }
 
-        const size_t NodeCount() const { return m_Nodes.size(); }
-        size_t NodeCount() { return m_Nodes.size(); }
+        // dense V x V adjacency materialized from the CSR (0 = no edge, the lighter
+        // one wins for parallel edges); only meant for small graphs
+        Matrix<W> GetMatrix() const {
+            const CSR &csr = freeze();
+            Matrix<W> matrix(W{}, csr.NodeCount());
 
-        const auto GetMatrix() const { return m_AdjMatrix; }
-        auto &GetMatrix() { return m_AdjMatrix; }
+            for (NodeID u = 0; u < csr.NodeCount(); u++) {
+                std::span<const NodeID> targets = csr.Targets(u);
+                std::span<const W> weights = csr.Weights(u);
 
-        void TryConnect(std::initializer_list<Relation<Node<T>, NodeWeight>> relations) {
-            for (Relation<Node<T>, NodeWeight> relation : relations) {
-                try {
-                    // auto src = relation.template get<0>();
-                    // auto dest = relation.template get<1>();
-                    // auto wt = relation.template get<2>();
-                    Node<T> src = relation.from();
-                    Node<T> dest = relation.to();
-                    NodeWeight wt = relation.weight();
+                // rows are sorted by weight, so walking them backwards leaves the minimum
+                for (size_t i = targets.size(); i-- > 0;)
+                    matrix.At(u)[targets[i]] = weights[i];
+            }
 
-                    m_Connectivity.at(src);
+            return matrix;
+        }
 
-                    m_Nodes.emplace(src);
-                    m_Nodes.emplace(dest);
-                    m_Connectivity[src].insert({dest, wt});
+        void TryConnect(std::initializer_list<Relation<Node<T>, W>> relations) {
+            const size_t first = m_PendingEdges.size();
 
-                    m_edges_initialized = false;
+            for (Relation<Node<T>, W> relation : relations) {
+                Node<T> src = relation.from();
+                Node<T> dest = relation.to();
+                W wt = relation.weight();
 
-                } catch (const std::out_of_range &) {
-                    std::cout << "Node " << relation.template get<0>()
-                              << " not found in map.\n";
+                NodeID from = m_Symbols.Find(src.GetData());
+                if (from == INVALID_NODE) {
+                    std::cout << "Node " << src << " not found in map.\n";
                     continue;
                 }
+
+                m_PendingEdges.push_back({from, m_Symbols.Intern(dest.GetData()), wt});
             }
+
+            edges_added(first);
         }
 
-        void Connect(std::initializer_list<Relation<Node<T>, NodeWeight>> relations) {
-            for (Relation<Node<T>, NodeWeight> relation : relations) {
-                Node<T> from = relation.from();
-                Node<T> to = relation.to();
-                NodeWeight wt = relation.weight();
+        void Connect(std::initializer_list<Relation<Node<T>, W>> relations) {
+            const size_t first = m_PendingEdges.size();
 
-                m_Nodes.emplace(from);
-                m_Nodes.emplace(to);
-                m_Connectivity[from]; // ensures insertion
-                m_Connectivity.at(from).insert(std::make_pair(to, wt));
+            for (Relation<Node<T>, W> relation : relations)
+                m_PendingEdges.push_back({m_Symbols.Intern(relation.from().GetData()),
+                                          m_Symbols.Intern(relation.to().GetData()),
+                                          relation.weight()});
 
-                m_edges_initialized = false;
-            }
+            edges_added(first);
         }
 
-        void Connect(Relation<Node<T>, NodeWeight> relation) {
-            Node<T> from = relation.from();
-            Node<T> to = relation.to();
-            NodeWeight wt = relation.weight();
+        void Connect(Relation<Node<T>, W> relation) { Connect({relation}); }
 
-            m_Nodes.emplace(from);
-            m_Nodes.emplace(to);
-            m_Connectivity[from]; // ensures insertion
-            m_Connectivity.at(from).insert(std::make_pair(to, wt));
+        // replaces every key -> target edge with a single one of the given weight
+        void SetWeight(Node<T> key, Node<T> target, W weight) {
+            NodeID from = m_Symbols.Find(key.GetData());
+            NodeID to = m_Symbols.Find(target.GetData());
 
-            m_edges_initialized = false;
-        }
+            if (from == INVALID_NODE || to == INVALID_NODE) {
+                std::cout << "Node not in map. (" << (from == INVALID_NODE ? key : target)
+                          << ")\n";
+                return;
+            }
 
-        void TryDisconnect(
-            std::initializer_list<Relation<Node<T>, NodeWeight>> relations) {
-            for (Relation<Node<T>, NodeWeight> relation : relations) {
-                Node<T> key = relation.template get<0>();
-
-                try {
-                    std::pair<Node<T>, NodeWeight> value = {relation.template get<1>(),
-                                                            relation.template get<2>()};
-
-                    m_Connectivity.at(key).remove_if(
-                        [&value](std::pair<Node<T>, NodeWeight> elem) {
-                            return elem == value;
-                        });
-
-                    m_edges_initialized = false;
-                } catch (const std::out_of_range &) {
-                    std::cout << "Node not in map. (" << key << ")\n";
-                    continue;
-                }
+            std::vector<Edge> edges = freeze().Edges();
+            std::vector<Edge> removed = take_edges(
+                edges, [from, to](const Edge &edge) { return edge.from == from && edge.to == to; });
+
+            const Edge edge = {from, to, weight};
+            edges.push_back(edge);
+            replace_csr(CSR(m_Symbols.Size(), edges));
+            m_Cache.Clear();
+
+            if (!repairable()) {
+                invalidate_distances();
+                return;
             }
+
+            // only a heavier edge can lengthen paths, a lighter one just adds shortcuts
+            W lightest = InfinityOf<W>();
+            for (const Edge &old : removed)
+                lightest = std::min(lightest, old.weight);
+
+            if (weight > lightest)
+                Repair::Remove(m_CSR, m_Distances, removed, m_ThreadCount);
+            else
+                Repair::Insert(m_CSR, m_Distances, std::span<const Edge>(&edge, 1), m_ThreadCount);
         }
 
-        void TryDisconnect(Relation<Node<T>, NodeWeight> relation) {
-            Node<T> key = relation.template get<0>();
+        void TryDisconnect(
+            std::initializer_list<Relation<Node<T>, W>> relations) {
+            for (Relation<Node<T>, W> relation : relations)
+                TryDisconnect(relation);
+        }
 
-            try {
-                std::pair<Node<T>, NodeWeight> value = {relation.template get<1>(),
-                                                        relation.template get<2>()};
-                m_Connectivity.at(key).remove_if(
-                    [&value](std::pair<Node<T>, NodeWeight> elem) {
-                        return elem == value;
-                    });
+        void TryDisconnect(Relation<Node<T>, W> relation) {
+            Node<T> key = relation.from();
+            NodeID from = m_Symbols.Find(key.GetData());
+            NodeID to = m_Symbols.Find(relation.to().GetData());
+            W wt = relation.weight();
 
-                m_edges_initialized = false;
-            } catch (const std::out_of_range &) {
+            if (from == INVALID_NODE) {
                 std::cout << "Node not in map. (" << key << ")\n";
                 return;
             }
+
+            remove_edges([from, to, wt](const Edge &edge) {
+                return edge.from == from && edge.to == to && edge.weight == wt;
+            });
         }
 
         void TryDisconnect(Node<T> key, Node<T> target) {
-            try {
-                m_Connectivity.at(key).remove_if(
-                    [&target](std::pair<Node<T>, NodeWeight> elem) {
-                        return elem.first == target;
-                    });
-
-                m_edges_initialized = false;
-            } catch (const std::out_of_range &) {
+            NodeID from = m_Symbols.Find(key.GetData());
+            NodeID to = m_Symbols.Find(target.GetData());
+
+            if (from == INVALID_NODE) {
                 std::cout << "Node not in map. (" << key << ")\n";
                 return;
             }
-        }
 
-        friend std::ostream &operator<<(std::ostream &os, const Graph<T> &obj) {
-            std::unordered_set<Node<T>, NodeHash<T>> nodes = obj.GetNodes();
+            remove_edges(
+                [from, to](const Edge &edge) { return edge.from == from && edge.to == to; });
+        }
 
+        friend std::ostream &operator<<(std::ostream &os, const Graph &obj) {
             os << "-------\nNodes:\n";
-            for (Node<T> node : nodes)
-                os << "{ " << node.GetData() << " }\n";
+            for (const Symbol &node : obj.GetNodes())
+                os << "{ " << node << " }\n";
 
             os << "\nDelta:\n";
             obj.PrintConnections(os);
@@ -204,434 +334,975 @@ template <typename T> class Graph {
 
         void PrintConnections(std::ostream &os) const {
             size_t max = 0;
-            for (const std::string &name : m_NodeNames)
-                if (name.length() > max)
-                    max = name.length();
+            if constexpr (std::is_convertible_v<const T &, std::string_view>)
+                for (const Symbol &name : m_Symbols.Symbols())
+                    if (std::string_view(name).length() > max)
+                        max = std::string_view(name).length();
+
+            const CSR &csr = freeze();
+            for (NodeID u = 0; u < csr.NodeCount(); u++) {
+                const Symbol &dest = m_Symbols.Get(u);
 
-            for (auto [dest, srcList] : m_Connectivity) {
-                if (srcList.empty()) {
+                if (csr.Degree(u) == 0) {
                     os << "[X] " << std::setw(max - 3) << dest
                        << " does not connect to any node.\n";
                     continue;
                 }
 
+                std::span<const NodeID> targets = csr.Targets(u);
+                std::span<const W> weights = csr.Weights(u);
+
                 os << std::setw(max) << dest << " -> { ";
-                for (const std::pair<Node<T>, NodeWeight> &src : srcList)
-                    os << src.first << ": " << src.second << ", ";
+                for (size_t i = 0; i < targets.size(); i++)
+                    os << m_Symbols.Get(targets[i]) << ": " << FromWeight(weights[i]) << ", ";
 
                 os << "\b\b }" << std::endl;
             }
         }
 
         void LoadFromFile(const std::string &filename = "graf2.txt") {
+            SPA_STAT_PHASE(PHASE_LOAD);
             // FILE FORMATTED AS:
             // node_count
             // node_names
             /*
                 [adjacency matrix]
             */
-            m_edges_initialized = false;
+            invalidate_distances();
             m_Filename = filename;
 
-            uint32_t nodeCount;
-            std::vector<std::vector<NodeWeight>> adjMatrix;
-            std::string line;
-
-            const std::regex whitespace("\\s+");
-            std::ifstream file(filename);
-            file.seekg(std::ios::beg);
-
-            std::getline(file, line, '\n');
-            line.pop_back(); // removes carriage return
-            nodeCount = std::stoi(line);
-            line.clear();
-
-            std::getline(file, line, '\n');
-            line.pop_back(); // removes carriage return
-            std::sregex_token_iterator iter(line.begin(), line.end(), whitespace, -1);
-            std::sregex_token_iterator end;
-            std::vector<T> nodeNames(iter, end);
-            m_NodeNames = nodeNames;
-            line.clear();
-
-            while (std::getline(file, line, '\n')) {
-                if (line[line.size()] == '\r')
-                    line.pop_back(); // removes carriage return
-
-                adjMatrix.push_back(tokenizeWeights(line));
-                line.clear();
-            }
+            MappedFile file(filename);
+            LineCursor cursor(file.View());
+            std::string_view line, token;
 
-            m_AdjMatrix = adjMatrix;
+            uint32_t nodeCount = 0;
+            if (!cursor.Next(line) || !ParseNumber(NextToken(line), nodeCount))
+                throw(ParseError(filename, cursor.LineNumber(), "expected the node count"));
 
-            // initialize node hashset
-            for (const auto &name : nodeNames) {
-                Node<T> node(name);
-                m_Nodes.emplace(node);
-                m_Connectivity[node];
-            }
+            // rows can be adopted as CSR as-is if the names map onto IDs 0..n-1
+            const bool adopt =
+                m_Symbols.Size() == 0 && m_PendingEdges.empty() && m_CSR.EdgeCount() == 0;
 
-            // initialize the relation hashmap
-            for (int i = 0; i < nodeCount; i++) {
-                Node<T> source(m_NodeNames.at(i));
+            std::vector<NodeID> ids;
+            ids.reserve(nodeCount);
+            m_Symbols.Reserve(m_Symbols.Size() + nodeCount);
 
-                for (int j = 0; j < nodeCount; j++) {
-                    NodeWeight wt = (adjMatrix.at(i)).at(j);
-                    Node<T> dest(m_NodeNames.at(j));
+            cursor.Next(line);
+            while (!(token = NextToken(line)).empty())
+                ids.push_back(intern_token(token));
+
+            if (ids.size() != nodeCount)
+                throw(ParseError(filename, cursor.LineNumber(),
+                                 "expected " + std::to_string(nodeCount) + " node names, found " +
+                                     std::to_string(ids.size())));
+
+            // parse the matrix straight into CSR-shaped rows, zero cells are skipped
+            std::vector<size_t> offsets = {0};
+            std::vector<NodeID> targets;
+            std::vector<W> weights;
+            offsets.reserve(nodeCount + 1);
+
+            while (offsets.size() <= nodeCount && cursor.Next(line)) {
+                size_t col = 0;
+
+                while (!(token = NextToken(line)).empty()) {
+                    W wt;
+                    if (col >= nodeCount)
+                        throw(ParseError(filename, cursor.LineNumber(), "too many weights"));
+                    if (!ParseWeight(token, wt))
+                        throw(ParseError(filename, cursor.LineNumber(),
+                                         "malformed weight \"" + std::string(token) + "\""));
 
                     if (wt) {
-                        Relation<Node<T>, NodeWeight> rel(source, dest, wt);
-                        Connect(rel);
+                        targets.push_back(ids[col]);
+                        weights.push_back(wt);
                     }
+
+                    col++;
                 }
+
+                if (col == 0)
+                    continue; // blank line
+
+                if (col != nodeCount)
+                    throw(ParseError(filename, cursor.LineNumber(),
+                                     "expected " + std::to_string(nodeCount) +
+                                         " weights, found " + std::to_string(col)));
+
+                offsets.push_back(targets.size());
             }
 
-            init_edge_distances();
+            if (offsets.size() <= nodeCount)
+                throw(ParseError(filename, cursor.LineNumber(),
+                                 "expected " + std::to_string(nodeCount) + " matrix rows"));
+
+            if (adopt && m_Symbols.Size() == nodeCount) {
+                replace_csr(CSR(std::move(offsets), std::move(targets), std::move(weights)));
+            } else {
+                m_PendingEdges.reserve(m_PendingEdges.size() + targets.size());
+
+                for (size_t row = 0; row < nodeCount; row++)
+                    for (size_t i = offsets[row]; i < offsets[row + 1]; i++)
+                        m_PendingEdges.push_back({ids[row], targets[i], weights[i]});
+            }
         }
 
+        // FILE FORMATTED AS one edge per line:
+        // source_name target_name [weight]
+        // the weight defaults to 1, lines starting with '#' or '%' are comments.
+        void LoadEdgeList(const std::string &filename) {
+            SPA_STAT_PHASE(PHASE_LOAD);
+            invalidate_distances();
+            m_Filename = filename;
+
+            MappedFile file(filename);
+            std::vector<std::vector<RawEdge>> parsed =
+                parse_chunks<RawEdge>(file.View(), [&](std::string_view line, auto &out) {
+                    std::string_view from = NextToken(line);
+                    if (from.empty() || from.front() == '#' || from.front() == '%')
+                        return;
+
+                    std::string_view to = NextToken(line), token = NextToken(line);
+                    W wt = ToWeight<W>(1);
+
+                    if (to.empty())
+                        throw(ParseError(filename, LineOf(file.View(), from.data()),
+                                         "expected a target node"));
+                    if (!token.empty() && !ParseWeight(token, wt))
+                        throw(ParseError(filename, LineOf(file.View(), token.data()),
+                                         "malformed weight \"" + std::string(token) + "\""));
+
+                    out.push_back({from, to, wt});
+                });
+
+            // interning runs in file order so IDs do not depend on the thread count
+            size_t total = 0;
+            for (const std::vector<RawEdge> &chunk : parsed)
+                total += chunk.size();
+
+            m_PendingEdges.reserve(m_PendingEdges.size() + total);
+            for (const std::vector<RawEdge> &chunk : parsed)
+                for (const RawEdge &edge : chunk)
+                    m_PendingEdges.push_back(
+                        {intern_token(edge.from), intern_token(edge.to), edge.weight});
+        }
+
+        // Matrix Market coordinate file (real, integer or pattern; general or
+        // symmetric). Nodes are named by their 1-based index, pattern entries get
+        // weight 1.
+        void LoadMatrixMarket(const std::string &filename) {
+            SPA_STAT_PHASE(PHASE_LOAD);
+            invalidate_distances();
+            m_Filename = filename;
+
+            MappedFile file(filename);
+            LineCursor cursor(file.View());
+            std::string_view line, token;
+
+            if (!cursor.Next(line) || NextToken(line) != "%%MatrixMarket" ||
+                NextToken(line) != "matrix")
+                throw(ParseError(filename, 1, "missing %%MatrixMarket matrix header"));
+
+            std::string_view format = NextToken(line), field = NextToken(line),
+                             symmetry = NextToken(line);
+            if (format != "coordinate")
+                throw(ParseError(filename, 1, "only the coordinate format is supported"));
+            if (field != "real" && field != "integer" && field != "pattern" && field != "double")
+                throw(ParseError(filename, 1, "unsupported field \"" + std::string(field) + "\""));
+            if (symmetry != "general" && symmetry != "symmetric")
+                throw(ParseError(filename, 1,
+                                 "unsupported symmetry \"" + std::string(symmetry) + "\""));
+
+            const bool pattern = field == "pattern", symmetric = symmetry == "symmetric";
+
+            // skip comments up to the "rows cols entries" size line
+            do {
+                if (!cursor.Next(line))
+                    throw(ParseError(filename, cursor.LineNumber(), "missing size line"));
+            } while (line.empty() || line.front() == '%');
+
+            size_t rows = 0, cols = 0, entries = 0;
+            if (!ParseNumber(NextToken(line), rows) || !ParseNumber(NextToken(line), cols) ||
+                !ParseNumber(NextToken(line), entries))
+                throw(ParseError(filename, cursor.LineNumber(), "malformed size line"));
+
+            const size_t nodeCount = std::max(rows, cols);
+            std::vector<NodeID> ids(nodeCount);
+            m_Symbols.Reserve(m_Symbols.Size() + nodeCount);
+            for (size_t i = 0; i < nodeCount; i++)
+                ids[i] = m_Symbols.Intern(ParseSymbol<T>(std::to_string(i + 1)));
+
+            std::string_view body = file.View().substr(std::min(cursor.Position(), file.Size()));
+            std::vector<std::vector<Edge>> parsed =
+                parse_chunks<Edge>(body, [&](std::string_view line, auto &out) {
+                    std::string_view first = NextToken(line);
+                    if (first.empty() || first.front() == '%')
+                        return;
+
+                    std::string_view second = NextToken(line), third = NextToken(line);
+                    size_t i = 0, j = 0;
+                    W wt = ToWeight<W>(1);
+
+                    if (!ParseNumber(first, i) || !ParseNumber(second, j) ||
+                        (!pattern && !ParseWeight(third, wt)))
+                        throw(ParseError(filename, LineOf(file.View(), first.data()),
+                                         "malformed entry"));
+                    if (i == 0 || i > rows || j == 0 || j > cols)
+                        throw(ParseError(filename, LineOf(file.View(), first.data()),
+                                         "entry out of range"));
+
+                    out.push_back({ids[i - 1], ids[j - 1], wt});
+                    if (symmetric && i != j)
+                        out.push_back({ids[j - 1], ids[i - 1], wt});
+                });
+
+            size_t total = 0;
+            for (const std::vector<Edge> &chunk : parsed)
+                total += chunk.size();
+
+            m_PendingEdges.reserve(m_PendingEdges.size() + total);
+            for (const std::vector<Edge> &chunk : parsed)
+                m_PendingEdges.insert(m_PendingEdges.end(), chunk.begin(), chunk.end());
+        }
+
+        // depth-first preorder from start, the visit order counting from 1
         template <typename RType>
-        void DFS(Node<T> start, const std::function<RType(Node<T>, int16_t)> &action) {
-            if (m_Nodes.find(start) == m_Nodes.end()) {
+        void DFS(Node<T> start, const std::function<RType(Node<T>, uint32_t)> &action) {
+            NodeID startID = m_Symbols.Find(start.GetData());
+            if (startID == INVALID_NODE) {
                 std::cout << "[!] Node \"" << start
                           << "\" not found in graph - returning..." << std::endl;
                 return;
             }
 
-            std::stack<Node<T>> st({start});
-            uint16_t iteration = 1;
-
-            // refresh the visited-map and init with a new, false-filled one
-            m_Visited.clear();
-            for (Node<T> node : m_Nodes)
-                m_Visited[node] = false;
+            [[maybe_unused]] size_t visited =
+                Walk::DFS(freeze(), startID,
+                          [&](NodeID id, uint32_t order) { action(node_of(id), order); });
 
-            while (st.size() > 0) {
-                Node<T> current = st.top();
-                st.pop();
+            SPA_STAT_ADD(dfsVisits, visited);
+        }
 
-                if (m_Visited.at(current) == false) {
-                    action(current, iteration++);
-                    m_Visited.at(current) = true;
+        // groups of mutually reachable nodes, ordered by their lowest node ID
+        std::vector<std::vector<Node<T>>> StronglyConnectedComponents() const {
+            return node_groups(Walk::StronglyConnected(freeze()));
+        }
 
-                    std::unordered_set<Node<T>, NodeHash<T>> neighbors =
-                        neighborsOf(current);
-                    for (Node<T> w : neighbors)
-                        if (m_Visited.at(w) == false)
-                            st.push(w);
-                }
-            }
+        // groups of nodes connected when edge directions are ignored, ordered by their
+        // lowest node ID; large graphs are processed on the worker threads
+        std::vector<std::vector<Node<T>>> WeaklyConnectedComponents() const {
+            return node_groups(Walk::WeaklyConnected(freeze(), m_ThreadCount));
         }
 
-        std::vector<std::pair<Node<T>, NodeWeight>> GetClosest(
+        // the `limit` nearest targets at a nonzero distance; zero-weight edges put
+        // targets at distance 0 first, so the search widens until enough remain
+        std::vector<std::pair<Node<T>, PathWeight>> GetClosest(
             Node<T> target, int16_t limit = 5, std::string criteria = "weights") {
-            std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> spt = Dijkstra(target);
+            const size_t wanted = std::max<int16_t>(limit, 0);
+            std::vector<std::pair<Node<T>, PathWeight>> result;
 
-            std::vector<std::pair<Node<T>, NodeWeight>> vec = hashmapToVector(spt),
-                                                        result;
-            std::sort(vec.begin(), vec.end(), [](const auto &pA, const auto &pB) {
-                return pA.second < pB.second;
-            });
+            for (size_t k = wanted; k > 0; k *= 2) {
+                result = KNearest(target, k);
+                const bool exhausted = result.size() < k;
 
-            for (const auto &elem : vec)
-                if (elem.second != 0 && elem.second != INF)
-                    result.push_back(elem);
+                std::erase_if(result, [](const auto &elem) { return elem.second == 0; });
+                if (result.size() >= wanted || exhausted)
+                    break;
+            }
 
-            if (limit < result.size())
-                result.resize(limit);
+            if (result.size() > wanted)
+                result.resize(wanted);
 
             return result;
         }
 
-        std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> Dijkstra(
-            Node<T> source, std::string flag = "weights") {
-            const size_t numNodes = m_Nodes.size();
-            std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> distances, numEdges;
-            std::unordered_set<Node<T>, NodeHash<T>> spt;
+        // the k nodes nearest to source (source itself excluded), sorted ascendingly
+        // by distance; the search stops as soon as they are all settled, and the
+        // result is kept in the source cache for later queries
+        std::vector<std::pair<Node<T>, PathWeight>> KNearest(Node<T> source, size_t k) {
+            NodeID sourceID = m_Symbols.Find(source.GetData());
+            if (sourceID == INVALID_NODE)
+                return {};
 
-            m_Visited.clear();
-            init_indices();
+            return nearest_result(nearest_targets(freeze(), sourceID, k));
+        }
 
-            for (Node<T> node : m_Nodes) {
-                distances[node] = INF;
-                numEdges[node] = INF;
-                m_Visited[node] = false;
-            }
+        // KNearest for a whole batch in one call: the adjacency is frozen once and the
+        // sources are fanned out over the worker threads, each searching in its own
+        // thread-local workspace; results[i] answers sources[i]
+        std::vector<std::vector<std::pair<Node<T>, PathWeight>>> KNearestBatch(
+            std::span<const Node<T>> sources, size_t k) {
+            const CSR &csr = freeze();
+            std::vector<std::vector<std::pair<Node<T>, PathWeight>>> results(sources.size());
 
-            distances[source] = 0;
-            numEdges[source] = 0;
+            for_each_source(sources, [&](size_t i, NodeID sourceID) {
+                results[i] = nearest_result(nearest_targets(csr, sourceID, k));
+            });
 
-            while (spt.size() < m_Nodes.size()) {
-                Node<T> current = findMinNode(spt, distances);
-                spt.emplace(current);
-                m_Visited[current] = true;
+            return results;
+        }
 
-                NodeSet adjacent = m_Connectivity[current];
+        // distance, hop count and node sequence of a shortest source -> target path, found
+        // by a bidirectional search that stops as soon as the two frontiers meet, on the
+        // contraction hierarchy if one is built; an unknown or unreachable target yields
+        // an infinite distance and no nodes. Either way the path is some lightest one,
+        // so its hop count can exceed DistanceTable::Hops when several paths tie.
+        Path ShortestPath(Node<T> source, Node<T> target) const {
+            NodeID sourceID = m_Symbols.Find(source.GetData());
+            NodeID targetID = m_Symbols.Find(target.GetData());
+            if (sourceID == INVALID_NODE || targetID == INVALID_NODE)
+                return {};
+
+            typename SSSP::Path found =
+                HasHierarchy() ? m_Hierarchy.Query(sourceID, targetID)
+                               : SSSP::Between(freeze(), reverse(), sourceID, targetID);
+
+            Path path = {found.distance, found.hops, {}};
+            path.nodes.reserve(found.nodes.size());
+            for (NodeID id : found.nodes)
+                path.nodes.push_back(node_of(id));
+
+            return path;
+        }
 
-                for (std::pair<Node<T>, NodeWeight> w : adjacent) {
-                    if (m_Visited[w.first] == false) {
-                        m_Visited[w.first] = true;
-                        if (distances[current] + w.second < distances[w.first]) {
-                            distances[w.first] = distances[current] + w.second;
-                            numEdges[w.first] = numEdges[current] + 1;
-                        }
-                    }
-                }
-            }
+        std::unordered_map<Node<T>, PathWeight, NodeHash<T>> Dijkstra(
+            Node<T> source, std::string flag = "weights") {
+            NodeID sourceID = m_Symbols.Find(source.GetData());
+            if (sourceID == INVALID_NODE)
+                return {};
 
-            std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> edges, weights;
+            return distance_result(all_targets(freeze(), sourceID), flag == "weights");
+        }
+
+        // Dijkstra for a whole batch, fanned out like KNearestBatch
+        std::vector<std::unordered_map<Node<T>, PathWeight, NodeHash<T>>> DijkstraBatch(
+            std::span<const Node<T>> sources, std::string flag = "weights") {
+            const CSR &csr = freeze();
+            std::vector<std::unordered_map<Node<T>, PathWeight, NodeHash<T>>> results(
+                sources.size());
 
-            for (auto &[k, v] : numEdges)
-                if (v != INF)
-                    edges[k] = v;
+            for_each_source(sources, [&](size_t i, NodeID sourceID) {
+                results[i] = distance_result(all_targets(csr, sourceID), flag == "weights");
+            });
 
-            for (auto &[k, v] : distances)
-                if (v != INF)
-                    weights[k] = v;
+            return results;
+        }
 
-            auto edgesSet = flatten(edges);
-            auto weightsSet = flatten(weights);
-            m_EdgeDistances[source] = edgesSet;
-            m_WeightDistances[source] = weightsSet;
+        // preprocesses the current adjacency into a contraction hierarchy that answers
+        // ShortestPath from then on; any later change of the adjacency drops it again,
+        // and SaveSnapshot stores it alongside the graph
+        void BuildHierarchy() { m_Hierarchy = Hierarchy::Build(freeze()); }
 
-            if (flag == "weights")
-                return weights;
-            else
-                return edges;
+        bool HasHierarchy() const {
+            return freeze().NodeCount() > 0 && m_Hierarchy.NodeCount() == m_CSR.NodeCount();
         }
 
-        void printEdgeDistances(T data = NO_DATA<T>) {
-            if (data != NO_DATA<T>) { // only print for the specified node
-                Node<T> target(data);
+        // a budget of 0 bytes turns the source cache off
+        void SetCacheBudget(size_t bytes) { m_Cache.SetBudget(bytes); }
+        typename Cache::Stats GetCacheStats() const { return m_Cache.GetStats(); }
 
-                std::cout << "[" << target << "]" << std::endl;
-                for (auto elem : m_EdgeDistances.at(data)) {
-                    if (elem.second > 0)
-                        std::cout << elem.first << " = " << elem.second << std::endl;
-                }
+        void printEdgeDistances(T data = NO_DATA<T>) { print_distances(data, true); }
 
-                std::cout << std::endl;
-            } else { // print for all nodes (permutated)
-                for (auto [node, list] : m_EdgeDistances) {
-                    std::cout << "[" << node << "]" << std::endl;
+        void printWeightDistances(T data = NO_DATA<T>) { print_distances(data, false); }
+
+        // writes the node table, the adjacency and (if computed) the distance table
+        // into a binary snapshot that LoadSnapshot maps back without parsing
+        void SaveSnapshot(const std::string &filename) const {
+            const CSR &csr = freeze();
+            SnapshotWriter writer(filename, csr.NodeCount(), csr.EdgeCount(), weight_size(),
+                                  symbol_size());
 
-                    for (const auto &elem : list)
-                        if (elem.second > 0)
-                            std::cout << elem.first << " = " << elem.second << std::endl;
+            if constexpr (std::is_arithmetic_v<T>) {
+                writer.Write(SECTION_NAME_DATA, m_Symbols.Symbols());
+            } else {
+                std::vector<uint64_t> offsets = {0};
+                std::string data;
 
-                    std::cout << std::endl;
+                for (const Symbol &name : m_Symbols.Symbols()) {
+                    data += name;
+                    offsets.push_back(data.size());
                 }
+
+                writer.Write(SECTION_NAME_OFFSETS, offsets);
+                writer.Write(SECTION_NAME_DATA, std::span<const char>(data));
             }
-        }
 
-        void printWeightDistances(T data = NO_DATA<T>) {
-            if (data != NO_DATA<T>) { // only print for the specified node
-                Node<T> target(data);
+            writer.Write(SECTION_SYMBOL_INDEX, m_Symbols.StableIndex());
+            writer.Write(SECTION_CSR_OFFSETS, csr.Offsets());
+            writer.Write(SECTION_CSR_TARGETS, csr.Targets());
+            writer.Write(SECTION_CSR_WEIGHTS, csr.Weights());
 
-                std::cout << "[" << target << "]" << std::endl;
-                for (auto elem : m_WeightDistances.at(data)) {
+            if (m_weights_initialized && m_Distances.NodeCount() == csr.NodeCount()) {
+                writer.Write(SECTION_WEIGHT_TABLE, m_Distances.Weights());
+                writer.Write(SECTION_HOP_TABLE, m_Distances.Hops());
+            }
 
-                    if (elem.second > 0)
-                        std::cout << elem.first << " = " << elem.second << std::endl;
-                }
-                std::cout << std::endl;
-            } else { // print for all nodes (permutated)
-                for (auto [node, list] : m_WeightDistances) {
-                    std::cout << "[" << node << "]" << std::endl;
+            if (HasHierarchy()) {
+                writer.Write(SECTION_HIERARCHY_UP_OFFSETS, m_Hierarchy.UpOffsets());
+                writer.Write(SECTION_HIERARCHY_UP_ARCS, m_Hierarchy.UpArcs());
+                writer.Write(SECTION_HIERARCHY_DOWN_OFFSETS, m_Hierarchy.DownOffsets());
+                writer.Write(SECTION_HIERARCHY_DOWN_ARCS, m_Hierarchy.DownArcs());
+            }
 
-                    for (const auto &elem : list)
-                        if (elem.second > 0)
-                            std::cout << elem.first << " = " << elem.second << std::endl;
+            writer.Commit();
+        }
 
-                    std::cout << std::endl;
+        // replaces the graph with a snapshot; adjacency, symbol index, distance table
+        // and string names stay mapped, other node payloads are copied out
+        void LoadSnapshot(const std::string &filename) {
+            SPA_STAT_PHASE(PHASE_LOAD);
+            SnapshotReader reader(filename);
+            const SnapshotHeader &header = reader.Header();
+            std::shared_ptr<const void> keepAlive = reader.KeepAlive();
+
+            if (header.weightSize != weight_size() || header.symbolSize != symbol_size())
+                throw(std::runtime_error(filename + ": snapshot was written for another graph type"));
+
+            std::vector<Symbol> names;
+            names.reserve(header.nodeCount);
+
+            if constexpr (std::is_arithmetic_v<T>) {
+                std::span<const T> data = reader.Section<T>(SECTION_NAME_DATA);
+                names.assign(data.begin(), data.end());
+            } else {
+                std::span<const uint64_t> offsets = reader.Section<uint64_t>(SECTION_NAME_OFFSETS);
+                std::span<const char> data = reader.Section<char>(SECTION_NAME_DATA);
+
+                if (offsets.size() != header.nodeCount + 1 || offsets.back() > data.size())
+                    throw(std::runtime_error(filename + ": malformed node table"));
+
+                for (size_t i = 0; i < header.nodeCount; i++) {
+                    if (offsets[i] > offsets[i + 1])
+                        throw(std::runtime_error(filename + ": malformed node table"));
+
+                    std::string_view name(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+                    if constexpr (std::is_same_v<Symbol, std::string_view>)
+                        names.push_back(name);
+                    else
+                        names.push_back(ParseSymbol<T>(name));
                 }
             }
+
+            if (names.size() != header.nodeCount)
+                throw(std::runtime_error(filename + ": malformed node table"));
+
+            CSR csr = CSR::Map(reader.Section<size_t>(SECTION_CSR_OFFSETS),
+                               reader.Section<NodeID>(SECTION_CSR_TARGETS),
+                               reader.Section<W>(SECTION_CSR_WEIGHTS), keepAlive);
+            if (csr.NodeCount() != header.nodeCount)
+                throw(std::runtime_error(filename + ": malformed adjacency"));
+
+            DistanceTable<PathWeight> distances;
+            if (reader.Has(SECTION_WEIGHT_TABLE))
+                distances = DistanceTable<PathWeight>::Map(
+                    header.nodeCount, reader.Section<PathWeight>(SECTION_WEIGHT_TABLE),
+                    reader.Section<uint32_t>(SECTION_HOP_TABLE), keepAlive);
+
+            Hierarchy hierarchy;
+            if (reader.Has(SECTION_HIERARCHY_UP_OFFSETS)) {
+                using Arc = typename Hierarchy::Arc;
+                hierarchy = Hierarchy::Map(reader.Section<size_t>(SECTION_HIERARCHY_UP_OFFSETS),
+                                           reader.Section<Arc>(SECTION_HIERARCHY_UP_ARCS),
+                                           reader.Section<size_t>(SECTION_HIERARCHY_DOWN_OFFSETS),
+                                           reader.Section<Arc>(SECTION_HIERARCHY_DOWN_ARCS),
+                                           keepAlive);
+
+                if (hierarchy.NodeCount() != header.nodeCount)
+                    throw(std::runtime_error(filename + ": malformed hierarchy"));
+            }
+
+            m_Symbols.Restore(std::move(names),
+                              Buffer<NodeID>::Map(reader.Section<NodeID>(SECTION_SYMBOL_INDEX),
+                                                  keepAlive),
+                              keepAlive);
+            replace_csr(std::move(csr));
+            m_PendingEdges.clear();
+            m_Hierarchy = std::move(hierarchy);
+            m_Distances = std::move(distances);
+            m_Cache.Clear();
+            m_weights_initialized = !m_Distances.Empty();
+            m_Filename = filename;
         }
 
-        void DumpData() {
-            int32_t limit = 5;
-            std::string loc = m_OutDir + "rezultat_" + m_Filename;
-            std::vector<std::string> outputnodes;
+        // output format: rijecN [a1:wt1, a2:wt2, ... , aX:wtX]
+        // blocks of nodes are formatted on the worker threads, each into its own
+        // buffer, and the buffers are then written out in node order, one batch at a time;
+        // returns the path of the written file
+        std::string DumpData() {
+            SPA_STAT_PHASE(PHASE_DUMP);
+            init_nearest(DUMP_LIMIT);
+
+            std::string loc =
+                m_OutDir + "rezultat_" + std::filesystem::path(m_Filename).filename().string();
             std::ofstream file(loc, std::ios::out | std::ios::trunc);
-            file.seekp(std::ios::beg);
-
-            // output format: rijecN [a1:wt1, a2:wt2, ... , aX:wtX]
-
-            std::string line;
-            for (Node<T> node : m_Nodes) {
-                int count = limit;
-                line.clear();
-                outputnodes.clear();
-                line = node.GetData() + " [";
-                NodeSet connected = m_WeightDistances.at(node);
-
-                for (std::pair<Node<T>, NodeWeight> elem : connected) {
-                    std::string outputWeight;
-                    auto found = std::find_if(connected.begin(),
-                                              connected.end(),
-                                              [&connected, &elem](const auto &a) {
-                                                  return a.second == elem.second;
-                                              });
-                    if (found->first == node)
-                        continue; // skip processing of node itself
-
-                    // duplicate weight detected
-                    // poredi edgeDist od elem.first i found->first
-                    // to se nalazi u m_edgedist.at(node) NodeSet
-                    // trebam naci elem.first i found->first u m_edgedist.at(node)
-                    NodeWeight foundEdgeWt, elemEdgeWt, endWt;
-                    if (found != connected.end()) {
-
-                        for (auto [n, eDist] : m_EdgeDistances.at(node)) {
-                            if (n == found->first)
-                                foundEdgeWt = eDist;
-                            if (n == elem.first)
-                                elemEdgeWt = eDist;
-                        }
-
-                        if (elemEdgeWt <= foundEdgeWt)
-                            endWt = found->second;
-                        else
-                            endWt = elem.second;
-                    }
 
-                    endWt = round_to(endWt, 0.01);
-                    outputWeight = std::to_string(endWt);
-                    std::string result;
-                    int i = 0;
-                    while (i < 4)
-                        result.push_back(outputWeight[i++]);
+            const size_t nodeCount = m_Symbols.Size();
+            const size_t blockCount = (nodeCount + DUMP_BLOCK - 1) / DUMP_BLOCK;
+            const size_t threadCount = std::min(ResolveThreadCount(m_ThreadCount), blockCount);
 
-                    outputnodes.push_back(elem.first.GetData() + ":" + result + " ");
+            // a few blocks per worker keep them busy while bounding the buffered output
+            std::vector<std::string> buffers(std::max<size_t>(1, threadCount * 4));
 
-                    if (outputnodes.size() == limit)
-                        break;
-                }
+            for (size_t first = 0; first < blockCount; first += buffers.size()) {
+                const size_t count = std::min(buffers.size(), blockCount - first);
 
-                for (const std::string &elem : outputnodes)
-                    line += elem;
+                ParallelFor(count, threadCount, [&](size_t i, size_t) {
+                    std::string &buffer = buffers[i];
+                    buffer.clear();
 
-                if (outputnodes.size() > 0)
-                    line.pop_back();
+                    const size_t begin = (first + i) * DUMP_BLOCK;
+                    for (size_t node = begin; node < std::min(begin + DUMP_BLOCK, nodeCount);
+                         node++)
+                        dump_line((NodeID)node, buffer);
+                });
 
-                line += "]";
-                file << line << std::endl;
+                for (size_t i = 0; i < count; i++)
+                    file.write(buffers[i].data(), buffers[i].size());
             }
+
+            if (!file)
+                throw(std::runtime_error("cannot write " + loc));
+
+            return loc;
         }
 
     private:
-        NodeWeight round_to(NodeWeight val, double precision = 0.01) {
+        using Nearest = typename TopKTable<PathWeight>::Entry;
+
+        // nodes per DumpData formatting task, and targets listed per node
+        static constexpr size_t DUMP_BLOCK = 256;
+        static constexpr size_t DUMP_LIMIT = 5;
+
+        static double round_to(double val, double precision = 0.01) {
             return std::round(val / precision) * precision;
         }
 
-        NodeSet flatten(std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> dict) {
-            NodeSet result;
+        // sources per batch task, smaller batches are not worth a thread each
+        static constexpr size_t BATCH_GRAIN = 16;
+
+        // calls body(index, id) for the known sources of a batch on the worker threads;
+        // those persist (see WorkerPool), so their search workspaces carry over from
+        // one batch to the next
+        template <typename Body>
+        void for_each_source(std::span<const Node<T>> sources, Body &&body) const {
+            const size_t threadCount =
+                std::min(ResolveThreadCount(m_ThreadCount),
+                         std::max<size_t>(1, sources.size() / BATCH_GRAIN));
+
+            ParallelFor(
+                sources.size(), threadCount,
+                [&](size_t i, size_t) {
+                    NodeID sourceID = m_Symbols.Find(sources[i].GetData());
+                    if (sourceID != INVALID_NODE)
+                        body(i, sourceID);
+                },
+                BATCH_GRAIN);
+        }
 
-            for (auto &[k, v] : dict)
-                result.emplace(std::make_pair(k, v));
+        // the k + 1 nearest targets of source (source first) from the cache, or from a
+        // fresh search that is cached in turn
+        std::vector<typename Cache::Target> nearest_targets(const CSR &csr, NodeID source,
+                                                            size_t k) {
+            std::vector<typename Cache::Target> targets;
+            if (!m_Cache.Lookup(source, k + 1, targets)) {
+                const typename SSSP::Workspace &ws = SSSP::KNearest(csr, source, k);
+
+                // fewer settled nodes than asked for means the search ran dry
+                targets = cache_targets(ws);
+                m_Cache.Store(source, std::vector<typename Cache::Target>(targets),
+                              ws.Settled().size() <= k);
+            }
+
+            return targets;
+        }
+
+        // every target reachable from source, see nearest_targets
+        std::vector<typename Cache::Target> all_targets(const CSR &csr, NodeID source) {
+            std::vector<typename Cache::Target> targets;
+            if (!m_Cache.Lookup(source, std::numeric_limits<size_t>::max(), targets)) {
+                targets = cache_targets(SSSP::Run(csr, source));
+                m_Cache.Store(source, std::vector<typename Cache::Target>(targets), true);
+            }
+
+            return targets;
+        }
+
+        // drops the source itself, which always comes first
+        std::vector<std::pair<Node<T>, PathWeight>> nearest_result(
+            const std::vector<typename Cache::Target> &targets) const {
+            std::vector<std::pair<Node<T>, PathWeight>> result;
+            result.reserve(targets.size());
+
+            for (size_t i = 1; i < targets.size(); i++)
+                result.emplace_back(node_of(targets[i].id), targets[i].distance);
 
             return result;
         }
 
-        void init_weights() {
-            if (m_weights_initialized == true)
-                return;
-            for (const Node<T> &node : m_Nodes) {
-                std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> distanceTo =
-                    Dijkstra(node, "weights");
-                m_WeightDistances[node];
+        std::unordered_map<Node<T>, PathWeight, NodeHash<T>> distance_result(
+            const std::vector<typename Cache::Target> &targets, bool byWeight) const {
+            std::unordered_map<Node<T>, PathWeight, NodeHash<T>> result;
+            for (const typename Cache::Target &target : targets)
+                result[node_of(target.id)] =
+                    byWeight ? target.distance : (PathWeight)target.hops;
 
-                for (auto [k, v] : distanceTo)
-                    m_WeightDistances[node].insert({k, v});
+            return result;
+        }
+
+        // the settled nodes of a run in cache form, i.e. by ascending distance
+        static std::vector<typename Cache::Target> cache_targets(
+            const typename SSSP::Workspace &ws) {
+            std::vector<typename Cache::Target> targets;
+            targets.reserve(ws.Settled().size());
+
+            for (NodeID id : ws.Settled())
+                targets.push_back({id, ws.Distance(id), ws.Hops(id)});
+
+            return targets;
+        }
+
+        // copies the reachable part of a finished run into a fresh distance table row
+        void store_distances(const typename SSSP::Workspace &ws, std::span<PathWeight> weights,
+                             std::span<uint32_t> hops) const {
+            for (NodeID id : ws.Settled()) {
+                weights[id] = ws.Distance(id);
+                hops[id] = ws.Hops(id);
             }
+        }
 
-            m_weights_initialized = true;
+        // reachable targets of a precomputed row with their score (or fewest-edge
+        // count), sorted by it with ties in ID order
+        std::vector<std::pair<NodeID, double>> sorted_row(NodeID source, bool byHops) const {
+            std::vector<std::pair<NodeID, double>> row;
+
+            if (byHops) {
+                for (NodeID target = 0; target < m_HopDistances.NodeCount(); target++)
+                    if (m_HopDistances.Reachable(source, target))
+                        row.emplace_back(target, (double)m_HopDistances.Hops(source, target));
+            } else {
+                for (NodeID target = 0; target < m_Distances.NodeCount(); target++)
+                    if (m_Distances.Reachable(source, target))
+                        row.emplace_back(target, FromWeight(m_Distances.Weight(source, target)));
+            }
+
+            std::stable_sort(row.begin(), row.end(),
+                             [](const auto &pA, const auto &pB) { return pA.second < pB.second; });
+            return row;
         }
 
-        void init_edge_distances() {
-            if (m_edges_initialized == true)
-                return;
+        // appends "node [t1:w1 t2:w2 ...]" with the nearest targets of source
+        void dump_line(NodeID source, std::string &out) const {
+            AppendSymbol(out, m_Symbols.Get(source));
+            out += " [";
 
-            for (const Node<T> &node : m_Nodes) {
-                std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> distanceTo =
-                    Dijkstra(node, "edges");
-                m_EdgeDistances[node];
+            std::span<const Nearest> row = m_Nearest.Row(source);
+            for (size_t i = 0; i < row.size(); i++) {
+                if (i > 0)
+                    out += ' ';
 
-                for (auto [k, v] : distanceTo)
-                    m_EdgeDistances[node].insert({k, v});
+                AppendSymbol(out, m_Symbols.Get(row[i].id));
+                out += ':';
+                AppendFixed(out, round_to(FromWeight(row[i].weight), 0.01), 2);
             }
 
-            m_edges_initialized = true;
+            out += "]\n";
         }
 
-        // Returns an unsorted vector
-        std::vector<std::pair<Node<T>, NodeWeight>> hashmapToVector(
-            std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> dict) {
-            std::vector<std::pair<Node<T>, NodeWeight>> result;
+        // keeps the `limit` entries of row nearest by (weight, hops, ID), given every
+        // target at least as near as the last of them. Weight-0 targets are left
+        // out when source is the first of them (as it is without zero-weight edges), so
+        // a node never lists itself.
+        static void select_nearest(NodeID source, size_t limit, std::vector<Nearest> &row) {
+            if (zero_weight_targets(source, row) > 0)
+                std::erase_if(row, [](const Nearest &entry) { return entry.weight == 0; });
+
+            const size_t shown = std::min(limit, row.size());
+            std::partial_sort(row.begin(), row.begin() + shown, row.end(),
+                              [](const Nearest &a, const Nearest &b) {
+                                  return std::tie(a.weight, a.hops, a.id) <
+                                         std::tie(b.weight, b.hops, b.id);
+                              });
+            row.resize(shown);
+        }
 
-            for (const auto &elem : dict)
-                result.push_back(elem);
+        // how many weight-0 entries select_nearest drops from row, 0 if source is not
+        // the first of them
+        static size_t zero_weight_targets(NodeID source, const std::vector<Nearest> &row) {
+            NodeID firstZero = INVALID_NODE;
+            size_t zeros = 0;
 
-            return result;
+            for (const Nearest &entry : row)
+                if (entry.weight == 0) {
+                    firstZero = std::min(firstZero, entry.id);
+                    zeros++;
+                }
+
+            return firstZero == source ? zeros : 0;
         }
 
-        Node<T> findMinNode(
-            const std::unordered_set<Node<T>, NodeHash<T>> &spt,
-            const std::unordered_map<Node<T>, NodeWeight, NodeHash<T>> &distances) {
+        // fills one row per node on the worker threads, from the all-pairs table when
+        // it describes the current adjacency
+        void init_nearest(size_t k) {
+            const CSR &csr = freeze();
+            if (m_Nearest.NodeCount() == csr.NodeCount() && m_Nearest.K() == k)
+                return;
+
+            SPA_STAT_PHASE(PHASE_DISTANCES);
+            const bool precomputed =
+                m_weights_initialized && m_Distances.NodeCount() == csr.NodeCount();
+            TopKTable<PathWeight> table(csr.NodeCount(), k);
 
-            Node<T> minNode;
-            NodeWeight minValue = INF + 1; // :DDDD
+            ParallelFor(csr.NodeCount(), m_ThreadCount, [&](size_t id, size_t) {
+                thread_local std::vector<Nearest> row;
+                if (precomputed)
+                    table_candidates((NodeID)id, row);
+                else
+                    search_candidates(csr, (NodeID)id, k, row);
 
-            for (const auto &[node, value] : distances) {
-                if (spt.contains(node) == false && value <= minValue) {
-                    minNode = node;
-                    minValue = value;
+                select_nearest((NodeID)id, k, row);
+                table.SetRow((NodeID)id, row);
+            });
+
+            m_Nearest = std::move(table);
+        }
+
+        // every reachable target of a precomputed row
+        void table_candidates(NodeID source, std::vector<Nearest> &row) const {
+            std::span<const PathWeight> weights = m_Distances.WeightRow(source);
+            std::span<const uint32_t> hops = m_Distances.HopRow(source);
+            row.clear();
+
+            for (NodeID target = 0; target < weights.size(); target++)
+                if (hops[target] != InfinityOf<uint32_t>())
+                    row.push_back({target, weights[target], hops[target]});
+        }
+
+        // the k nearest targets of source and everything tied with the last of them;
+        // zero-weight targets that select_nearest will drop are searched past
+        static void search_candidates(const CSR &csr, NodeID source, size_t k,
+                                      std::vector<Nearest> &row) {
+            for (size_t depth = k;;) {
+                const typename SSSP::Workspace &ws = SSSP::KNearestWithTies(csr, source, depth);
+                row.clear();
+                for (NodeID id : ws.Settled())
+                    row.push_back({id, ws.Distance(id), ws.Hops(id)});
+
+                // every weight-0 target is settled by now, so this count is final
+                const size_t needed = k + zero_weight_targets(source, row);
+                if (row.size() >= needed || ws.Settled().size() <= depth)
+                    return;
+
+                depth = needed - 1;
+            }
+        }
+
+        void print_distances(const T &data, bool byHops) {
+            if (byHops)
+                init_edge_distances();
+            else
+                init_weights();
+
+            auto print_row = [&](NodeID source) {
+                std::cout << "[" << m_Symbols.Get(source) << "]" << std::endl;
+                for (auto [target, value] : sorted_row(source, byHops))
+                    if (value > 0)
+                        std::cout << m_Symbols.Get(target) << " = " << value << std::endl;
+
+                std::cout << std::endl;
+            };
+
+            if (data != NO_DATA<T>) { // only print for the specified node
+                NodeID source = m_Symbols.Find(data);
+                if (source == INVALID_NODE) {
+                    std::cout << "[!] Node \"" << data << "\" not found in graph." << std::endl;
+                    return;
                 }
+
+                print_row(source);
+            } else { // print for all nodes
+                for (NodeID source = 0; source < m_Symbols.Size(); source++)
+                    print_row(source);
             }
+        }
+
+        static constexpr uint32_t weight_size() {
+            return sizeof(W) | (std::is_integral_v<W> ? SNAPSHOT_FIXED_POINT : 0);
+        }
+
+        // 0 for string payloads, see SnapshotHeader::symbolSize
+        static constexpr uint32_t symbol_size() {
+            if constexpr (std::is_arithmetic_v<T>)
+                return sizeof(T);
+            else
+                return 0;
+        }
 
-            return minNode;
+        // the adjacency changed, so the precomputed table no longer describes it
+        void invalidate_distances() {
+            m_weights_initialized = false;
+            m_Cache.Clear();
         }
 
-        std::pair<Node<T>, NodeWeight> closest(Node<T> source) {
-            NodeSet distances = m_Connectivity[source];
+        void init_weights() {
+            if (m_weights_initialized == true)
+                return;
 
-            std::pair<Node<T>, NodeWeight> nearest = distances.front();
+            InitDistances();
+        }
 
-            for (const std::pair<Node<T>, NodeWeight> &elem : distances)
-                if (elem.second < nearest.second)
-                    nearest = elem;
+        // hop counts are an unweighted metric, so they come from the bit-parallel BFS
+        // rather than from the weighted all-pairs run
+        void init_edge_distances() {
+            const CSR &csr = freeze();
+            if (m_HopDistances.NodeCount() == csr.NodeCount())
+                return;
 
-            return nearest;
+            SPA_STAT_PHASE(PHASE_DISTANCES);
+            m_HopDistances = BitParallelBFS<W>::Run(csr, m_ThreadCount);
         }
 
-        std::vector<NodeWeight> tokenizeWeights(const std::string &feed,
-                                                char delim = ' ') {
-            std::stringstream ss(feed);
-            std::string token;
+        std::pair<Node<T>, W> closest(Node<T> source) {
+            const CSR &csr = freeze();
+            NodeID id = m_Symbols.Find(source.GetData());
 
-            std::vector<NodeWeight> result;
+            // rows are sorted by weight, so the nearest neighbor is the first one
+            if (id == INVALID_NODE || csr.Degree(id) == 0)
+                return {source, InfinityOf<W>()};
 
-            while (std::getline(ss, token, delim))
-                result.push_back(std::stod(token));
+            return {node_of(csr.Targets(id)[0]), csr.Weights(id)[0]};
+        }
 
-            return result;
+        // an edge list record whose names still point into the mapped file
+        struct RawEdge {
+                std::string_view from;
+                std::string_view to;
+                W weight;
+        };
+
+        // parses newline-aligned chunks of text on the worker threads, each chunk into
+        // its own output vector; parse(line, out) is called once per line
+        template <typename Record, typename Parser>
+        std::vector<std::vector<Record>> parse_chunks(std::string_view text, Parser &&parse) {
+            // tiny inputs are not worth a thread each
+            const size_t minChunk = 1 << 20;
+            size_t threadCount = std::min(ResolveThreadCount(m_ThreadCount),
+                                          std::max<size_t>(1, text.size() / minChunk));
+
+            std::vector<std::string_view> chunks = SplitLines(text, threadCount);
+            std::vector<std::vector<Record>> parsed(chunks.size());
+
+            ParallelFor(chunks.size(), threadCount, [&](size_t i, size_t) {
+                LineCursor cursor(chunks[i]);
+                std::string_view line;
+
+                while (cursor.Next(line))
+                    parse(line, parsed[i]);
+            });
+
+            return parsed;
+        }
+
+        NodeID intern_token(std::string_view token) {
+            if constexpr (std::is_same_v<T, std::string>)
+                return m_Symbols.Intern(token);
+            else
+                return m_Symbols.Intern(ParseSymbol<T>(token));
+        }
+
+        Node<T> node_of(NodeID id) const { return Node<T>(m_Symbols.Get(id)); }
+
+        std::vector<std::vector<Node<T>>> node_groups(const Components &components) const {
+            std::vector<std::vector<Node<T>>> groups(components.count);
+            for (NodeID id = 0; id < components.labels.size(); id++)
+                groups[components.labels[id]].push_back(node_of(id));
+
+            return groups;
+        }
+
+        // folds edges added since the last call (and any newly interned nodes)
+        // into a fresh CSR; a no-op while the graph is unchanged
+        const CSR &freeze() const {
+            if (m_PendingEdges.empty() && m_CSR.NodeCount() == m_Symbols.Size())
+                return m_CSR;
+
+            if (m_CSR.EdgeCount() == 0) {
+                replace_csr(CSR(m_Symbols.Size(), m_PendingEdges));
+            } else {
+                std::vector<Edge> edges = m_CSR.Edges();
+                edges.insert(edges.end(), m_PendingEdges.begin(), m_PendingEdges.end());
+                replace_csr(CSR(m_Symbols.Size(), edges));
+            }
+
+            m_PendingEdges.clear();
+            m_PendingEdges.shrink_to_fit();
+            return m_CSR;
+        }
+
+        // every change of the adjacency goes through here, so m_Reverse, the hierarchy
+        // and the hop table never go stale
+        void replace_csr(CSR &&csr) const {
+            m_CSR = std::move(csr);
+            m_Reverse = CSR();
+            m_Hierarchy = Hierarchy();
+            m_HopDistances = HopTable();
+            m_Nearest = TopKTable<PathWeight>();
+        }
+
+        const CSR &reverse() const {
+            const CSR &csr = freeze();
+            if (m_Reverse.NodeCount() != csr.NodeCount())
+                m_Reverse = csr.Transpose();
+
+            return m_Reverse;
         }
 
-        std::unordered_set<Node<T>, NodeHash<T>> neighborsOf(Node<T> target) {
-            std::unordered_set<Node<T>, NodeHash<T>> neighbors;
-            NodeSet connectedNodes = m_Connectivity[target];
+        // moves the edges matching predicate out of edges, keeping the order of the rest
+        template <typename Predicate>
+        static std::vector<Edge> take_edges(std::vector<Edge> &edges, Predicate predicate) {
+            auto kept = std::stable_partition(edges.begin(), edges.end(),
+                                              [&](const Edge &edge) { return !predicate(edge); });
+
+            std::vector<Edge> taken(kept, edges.end());
+            edges.erase(kept, edges.end());
+            return taken;
+        }
 
-            for (auto [node, wt] : connectedNodes)
-                neighbors.emplace(node);
+        template <typename Predicate> void remove_edges(Predicate predicate) {
+            std::vector<Edge> edges = freeze().Edges();
+            std::vector<Edge> removed = take_edges(edges, predicate);
 
-            return std::unordered_set<Node<T>, NodeHash<T>>(neighbors);
+            if (removed.empty())
+                return;
+
+            replace_csr(CSR(m_Symbols.Size(), edges));
+            m_Cache.Clear();
+
+            if (repairable())
+                Repair::Remove(m_CSR, m_Distances, removed, m_ThreadCount);
+            else
+                invalidate_distances();
         }
 
-        void init_indices() {
-            m_Indices.clear();
-            int32_t i = 0;
+        // an up-to-date table that edge updates can repair instead of dropping
+        bool repairable() const {
+            return m_Dynamic && m_weights_initialized &&
+                   m_Distances.NodeCount() == m_CSR.NodeCount();
+        }
+
+        // m_PendingEdges[first..] were just added; in dynamic mode they are folded in
+        // right away so the table can follow them
+        void edges_added(size_t first) {
+            if (first == m_PendingEdges.size())
+                return;
+
+            m_Cache.Clear();
+            if (first > 0 || !repairable()) {
+                invalidate_distances();
+                return;
+            }
 
-            for (Node<T> node : m_Nodes)
-                m_Indices.push_back(std::make_pair(node, i++));
+            std::vector<Edge> added = m_PendingEdges;
+            m_Distances.Resize(m_Symbols.Size());
+            Repair::Insert(freeze(), m_Distances, added, m_ThreadCount);
         }
         /* --- */
 };
\ No newline at end of file
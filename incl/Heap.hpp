@@ -0,0 +1,431 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "literals.hpp"
+
+/**
+ * @brief Addressable min-heaps over dense NodeIDs, used as Dijkstra frontiers.
+ * All of them share the same interface:
+ *
+ *  Reset(capacity)        - empties the heap and makes room for IDs < capacity
+ *  Push(id, key)          - inserts an ID that is not yet in the heap
+ *  DecreaseKey(id, key)   - lowers the key of an ID that is in the heap
+ *  Pop()                  - removes and returns the (id, key) pair with the lowest key
+ *
+ * The comparison heaps (DaryHeap, PairingHeap) break ties on the key by the lower
+ * ID; RadixHeap, the default for integer keys, pops ties in no particular order.
+ * Storage is sized once by Reset and reused afterwards, so a warmed-up heap never
+ * allocates.
+ */
+
+/**
+ * @brief Implicit d-ary heap with a position index for decrease-key.
+ * Arity 2 is the textbook binary heap, arity 4 trades a few extra comparisons per
+ * level for a shallower, more cache-friendly tree.
+ *
+ * @tparam Arity number of children per heap node
+ * @tparam W key data type
+ */
+template <size_t Arity, typename W = NodeWeight> class DaryHeap {
+        static_assert(Arity >= 2, "a heap node needs at least two children");
+
+    private:
+        static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+
+        std::vector<std::pair<W, NodeID>> m_Heap;
+        std::vector<uint32_t> m_Position;
+
+    public:
+        DaryHeap() {}
+
+        void Reset(size_t capacity) {
+            Clear();
+            if (m_Position.size() < capacity) {
+                m_Position.resize(capacity, NOT_IN_HEAP);
+                m_Heap.reserve(capacity);
+            }
+        }
+
+        void Clear() {
+            for (const auto &[key, id] : m_Heap)
+                m_Position[id] = NOT_IN_HEAP;
+
+            m_Heap.clear();
+        }
+
+        bool Empty() const { return m_Heap.empty(); }
+        size_t Size() const { return m_Heap.size(); }
+        bool Contains(NodeID id) const { return m_Position[id] != NOT_IN_HEAP; }
+        W Key(NodeID id) const { return m_Heap[m_Position[id]].first; }
+
+        std::pair<NodeID, W> Top() const { return {m_Heap.front().second, m_Heap.front().first}; }
+
+        void Push(NodeID id, W key) {
+            m_Heap.emplace_back(key, id);
+            m_Position[id] = (uint32_t)(m_Heap.size() - 1);
+            sift_up(m_Heap.size() - 1);
+        }
+
+        void DecreaseKey(NodeID id, W key) {
+            size_t idx = m_Position[id];
+            m_Heap[idx].first = key;
+            sift_up(idx);
+        }
+
+        std::pair<NodeID, W> Pop() {
+            auto [key, id] = m_Heap.front();
+            m_Position[id] = NOT_IN_HEAP;
+
+            if (m_Heap.size() > 1) {
+                m_Heap.front() = m_Heap.back();
+                m_Position[m_Heap.front().second] = 0;
+                m_Heap.pop_back();
+                sift_down(0);
+            } else {
+                m_Heap.pop_back();
+            }
+
+            return {id, key};
+        }
+
+    private:
+        void sift_up(size_t idx) {
+            std::pair<W, NodeID> elem = m_Heap[idx];
+
+            while (idx > 0) {
+                size_t parent = (idx - 1) / Arity;
+                if (!(elem < m_Heap[parent]))
+                    break;
+
+                m_Heap[idx] = m_Heap[parent];
+                m_Position[m_Heap[idx].second] = (uint32_t)idx;
+                idx = parent;
+            }
+
+            m_Heap[idx] = elem;
+            m_Position[elem.second] = (uint32_t)idx;
+        }
+
+        void sift_down(size_t idx) {
+            const size_t size = m_Heap.size();
+            std::pair<W, NodeID> elem = m_Heap[idx];
+
+            while (true) {
+                size_t first = idx * Arity + 1;
+                if (first >= size)
+                    break;
+
+                size_t last = std::min(first + Arity, size);
+                size_t best = first;
+                for (size_t child = first + 1; child < last; child++)
+                    if (m_Heap[child] < m_Heap[best])
+                        best = child;
+
+                if (!(m_Heap[best] < elem))
+                    break;
+
+                m_Heap[idx] = m_Heap[best];
+                m_Position[m_Heap[idx].second] = (uint32_t)idx;
+                idx = best;
+            }
+
+            m_Heap[idx] = elem;
+            m_Position[elem.second] = (uint32_t)idx;
+        }
+};
+
+template <typename W = NodeWeight> using BinaryHeap = DaryHeap<2, W>;
+template <typename W = NodeWeight> using QuaternaryHeap = DaryHeap<4, W>;
+
+/**
+ * @brief Pairing heap with O(1) insert and decrease-key, and amortized O(log n)
+ * pop using the two-pass pairing scheme. The tree is stored as intrusive
+ * child/sibling links in arrays indexed by NodeID, so it never allocates nodes.
+ *
+ * @tparam W key data type
+ */
+template <typename W = NodeWeight> class PairingHeap {
+    private:
+        std::vector<W> m_Key;
+        std::vector<NodeID> m_Child;
+        std::vector<NodeID> m_Next; // right sibling
+        std::vector<NodeID> m_Prev; // left sibling, or the parent for a leftmost child
+        std::vector<uint32_t> m_Stamp;
+        uint32_t m_Epoch = 1;
+        NodeID m_Root = INVALID_NODE;
+        size_t m_Size = 0;
+
+    public:
+        PairingHeap() {}
+
+        void Reset(size_t capacity) {
+            Clear();
+            if (m_Key.size() < capacity) {
+                m_Key.resize(capacity);
+                m_Child.resize(capacity);
+                m_Next.resize(capacity);
+                m_Prev.resize(capacity);
+                m_Stamp.resize(capacity, 0);
+            }
+        }
+
+        // membership is epoch-stamped, so clearing never touches the per-node arrays
+        void Clear() {
+            if (++m_Epoch == 0) {
+                std::fill(m_Stamp.begin(), m_Stamp.end(), 0);
+                m_Epoch = 1;
+            }
+
+            m_Root = INVALID_NODE;
+            m_Size = 0;
+        }
+
+        bool Empty() const { return m_Size == 0; }
+        size_t Size() const { return m_Size; }
+        bool Contains(NodeID id) const { return m_Stamp[id] == m_Epoch; }
+        W Key(NodeID id) const { return m_Key[id]; }
+
+        std::pair<NodeID, W> Top() const { return {m_Root, m_Key[m_Root]}; }
+
+        void Push(NodeID id, W key) {
+            m_Key[id] = key;
+            m_Child[id] = m_Next[id] = m_Prev[id] = INVALID_NODE;
+            m_Stamp[id] = m_Epoch;
+            m_Root = m_Root == INVALID_NODE ? id : link(m_Root, id);
+            m_Size++;
+        }
+
+        void DecreaseKey(NodeID id, W key) {
+            m_Key[id] = key;
+            if (id == m_Root)
+                return;
+
+            // detach the subtree rooted at id and meld it back with the root
+            NodeID prev = m_Prev[id];
+            if (m_Child[prev] == id)
+                m_Child[prev] = m_Next[id];
+            else
+                m_Next[prev] = m_Next[id];
+
+            if (m_Next[id] != INVALID_NODE)
+                m_Prev[m_Next[id]] = prev;
+
+            m_Next[id] = m_Prev[id] = INVALID_NODE;
+            m_Root = link(m_Root, id);
+        }
+
+        std::pair<NodeID, W> Pop() {
+            NodeID top = m_Root;
+            m_Stamp[top] = 0;
+            m_Size--;
+
+            // first pass: meld children pairwise left to right, stacking the results
+            // through their (now free) sibling links
+            NodeID stacked = INVALID_NODE;
+            NodeID current = m_Child[top];
+
+            while (current != INVALID_NODE) {
+                NodeID first = current, second = m_Next[first];
+                m_Prev[first] = INVALID_NODE;
+
+                if (second == INVALID_NODE) {
+                    m_Next[first] = stacked;
+                    stacked = first;
+                    break;
+                }
+
+                current = m_Next[second];
+                m_Next[first] = m_Next[second] = m_Prev[second] = INVALID_NODE;
+
+                NodeID melded = link(first, second);
+                m_Next[melded] = stacked;
+                stacked = melded;
+            }
+
+            // second pass: meld the stacked pairs right to left
+            m_Root = stacked;
+            if (m_Root != INVALID_NODE) {
+                current = m_Next[m_Root];
+                m_Next[m_Root] = INVALID_NODE;
+
+                while (current != INVALID_NODE) {
+                    NodeID next = m_Next[current];
+                    m_Next[current] = INVALID_NODE;
+                    m_Root = link(m_Root, current);
+                    current = next;
+                }
+
+                m_Prev[m_Root] = INVALID_NODE;
+            }
+
+            return {top, m_Key[top]};
+        }
+
+    private:
+        bool less(NodeID a, NodeID b) const {
+            return m_Key[a] < m_Key[b] || (m_Key[a] == m_Key[b] && a < b);
+        }
+
+        // melds two sibling-free roots, the loser becomes the leftmost child
+        NodeID link(NodeID a, NodeID b) {
+            if (less(b, a))
+                std::swap(a, b);
+
+            m_Next[b] = m_Child[a];
+            if (m_Child[a] != INVALID_NODE)
+                m_Prev[m_Child[a]] = b;
+
+            m_Prev[b] = a;
+            m_Child[a] = b;
+            return a;
+        }
+};
+
+/**
+ * @brief Radix heap: a bucket queue for integer keys that only works for monotone
+ * use, i.e. no key pushed may be lower than the last one popped, which Dijkstra
+ * guarantees. Bucket b holds the keys whose highest bit differing from the last
+ * popped key is bit b - 1, so bucket 0 holds the keys equal to it. Popping from an
+ * empty bucket 0 redistributes the lowest non-empty bucket, and every key can only
+ * move down, so a pop costs O(bits) amortized instead of O(log n) comparisons.
+ * Ties come out in no particular order.
+ *
+ * @tparam W integer key data type
+ */
+template <typename W> class RadixHeap {
+        static_assert(std::is_integral_v<W>, "a radix heap needs integer keys");
+
+    private:
+        using Bits = std::make_unsigned_t<W>;
+
+        static constexpr size_t BUCKETS = std::numeric_limits<Bits>::digits + 1;
+        static constexpr uint8_t NOT_IN_HEAP = std::numeric_limits<uint8_t>::max();
+
+        // Top() may have to redistribute, hence mutable
+        mutable std::vector<NodeID> m_Buckets[BUCKETS];
+        mutable std::vector<uint8_t> m_Bucket;
+        mutable std::vector<uint32_t> m_Slot; // index within its bucket
+        mutable W m_Last = 0;
+        std::vector<W> m_Key;
+        size_t m_Size = 0;
+
+    public:
+        RadixHeap() {}
+
+        void Reset(size_t capacity) {
+            Clear();
+            if (m_Key.size() < capacity) {
+                m_Key.resize(capacity);
+                m_Bucket.resize(capacity, NOT_IN_HEAP);
+                m_Slot.resize(capacity);
+            }
+        }
+
+        void Clear() {
+            for (std::vector<NodeID> &bucket : m_Buckets) {
+                for (NodeID id : bucket)
+                    m_Bucket[id] = NOT_IN_HEAP;
+
+                bucket.clear();
+            }
+
+            m_Last = 0;
+            m_Size = 0;
+        }
+
+        bool Empty() const { return m_Size == 0; }
+        size_t Size() const { return m_Size; }
+        bool Contains(NodeID id) const { return m_Bucket[id] != NOT_IN_HEAP; }
+        W Key(NodeID id) const { return m_Key[id]; }
+
+        std::pair<NodeID, W> Top() const {
+            refill();
+            NodeID id = m_Buckets[0].back();
+            return {id, m_Key[id]};
+        }
+
+        void Push(NodeID id, W key) {
+            m_Key[id] = key;
+            place(id);
+            m_Size++;
+        }
+
+        void DecreaseKey(NodeID id, W key) {
+            unlink(id);
+            m_Key[id] = key;
+            place(id);
+        }
+
+        std::pair<NodeID, W> Pop() {
+            refill();
+            NodeID id = m_Buckets[0].back();
+            m_Buckets[0].pop_back();
+            m_Bucket[id] = NOT_IN_HEAP;
+            m_Size--;
+
+            return {id, m_Key[id]};
+        }
+
+    private:
+        void place(NodeID id) const {
+            Bits diff = (Bits)m_Key[id] ^ (Bits)m_Last;
+            uint8_t bucket = (uint8_t)std::bit_width(diff);
+
+            m_Bucket[id] = bucket;
+            m_Slot[id] = (uint32_t)m_Buckets[bucket].size();
+            m_Buckets[bucket].push_back(id);
+        }
+
+        void unlink(NodeID id) const {
+            std::vector<NodeID> &bucket = m_Buckets[m_Bucket[id]];
+            NodeID moved = bucket.back();
+
+            bucket[m_Slot[id]] = moved;
+            m_Slot[moved] = m_Slot[id];
+            bucket.pop_back();
+        }
+
+        // makes bucket 0 non-empty: the lowest non-empty bucket is spread out around
+        // its minimum, which lands in bucket 0 and moves everything else lower too
+        void refill() const {
+            if (!m_Buckets[0].empty())
+                return;
+
+            size_t b = 1;
+            while (m_Buckets[b].empty())
+                b++;
+
+            std::vector<NodeID> &bucket = m_Buckets[b];
+            m_Last = m_Key[bucket.front()];
+            for (NodeID id : bucket)
+                m_Last = std::min(m_Last, m_Key[id]);
+
+            for (NodeID id : bucket)
+                place(id);
+
+            bucket.clear();
+        }
+};
+
+// comparison heap used by ShortestPaths for floating-point weights unless a heap is
+// passed explicitly, pick one with -DSPA_HEAP_BINARY or -DSPA_HEAP_PAIRING (the
+// 4-ary heap is the default)
+#if defined(SPA_HEAP_PAIRING)
+template <typename W = NodeWeight> using ComparisonHeap = PairingHeap<W>;
+#elif defined(SPA_HEAP_BINARY)
+template <typename W = NodeWeight> using ComparisonHeap = BinaryHeap<W>;
+#else
+template <typename W = NodeWeight> using ComparisonHeap = QuaternaryHeap<W>;
+#endif
+
+// integer (fixed-point) weights get the radix heap instead
+template <typename W = NodeWeight>
+using DefaultHeap =
+    std::conditional_t<std::is_integral_v<W>, RadixHeap<W>, ComparisonHeap<W>>;
\ No newline at end of file
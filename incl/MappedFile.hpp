@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Read-only memory mapping of a whole file. The mapping lives as long as the
+ * object, so views handed out by View() must not outlive it. `sequential` hints the
+ * OS to read ahead aggressively, which suits parsers but not random access.
+ */
+class MappedFile {
+    private:
+        const char *m_Data = nullptr;
+        size_t m_Size = 0;
+#ifdef _WIN32
+        HANDLE m_File = INVALID_HANDLE_VALUE;
+        HANDLE m_Mapping = nullptr;
+#else
+        int m_Descriptor = -1;
+#endif
+
+    public:
+        MappedFile() {}
+        explicit MappedFile(const std::string &filename, bool sequential = true) {
+            Open(filename, sequential);
+        }
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept { swap(other); }
+        MappedFile &operator=(MappedFile &&other) noexcept {
+            if (this != &other) {
+                Close();
+                swap(other);
+            }
+
+            return *this;
+        }
+
+        void Open(const std::string &filename, bool sequential = true) {
+            Close();
+
+#ifdef _WIN32
+            m_File = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING,
+                                 sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS,
+                                 nullptr);
+            if (m_File == INVALID_HANDLE_VALUE)
+                throw(std::runtime_error("cannot open " + filename));
+
+            LARGE_INTEGER size;
+            GetFileSizeEx(m_File, &size);
+            m_Size = (size_t)size.QuadPart;
+
+            if (m_Size > 0) {
+                m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (m_Mapping != nullptr)
+                    m_Data = (const char *)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+
+                if (m_Data == nullptr) {
+                    Close();
+                    throw(std::runtime_error("cannot map " + filename));
+                }
+            }
+#else
+            m_Descriptor = ::open(filename.c_str(), O_RDONLY);
+            if (m_Descriptor < 0)
+                throw(std::runtime_error("cannot open " + filename));
+
+            struct stat info;
+            if (fstat(m_Descriptor, &info) != 0) {
+                Close();
+                throw(std::runtime_error("cannot stat " + filename));
+            }
+
+            m_Size = (size_t)info.st_size;
+            if (m_Size > 0) {
+                void *data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_Descriptor, 0);
+                if (data == MAP_FAILED) {
+                    Close();
+                    throw(std::runtime_error("cannot map " + filename));
+                }
+
+                madvise(data, m_Size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                m_Data = (const char *)data;
+            }
+#endif
+        }
+
+        void Close() {
+#ifdef _WIN32
+            if (m_Data != nullptr)
+                UnmapViewOfFile(m_Data);
+            if (m_Mapping != nullptr)
+                CloseHandle(m_Mapping);
+            if (m_File != INVALID_HANDLE_VALUE)
+                CloseHandle(m_File);
+
+            m_Mapping = nullptr;
+            m_File = INVALID_HANDLE_VALUE;
+#else
+            if (m_Data != nullptr)
+                munmap((void *)m_Data, m_Size);
+            if (m_Descriptor >= 0)
+                ::close(m_Descriptor);
+
+            m_Descriptor = -1;
+#endif
+            m_Data = nullptr;
+            m_Size = 0;
+        }
+
+        bool IsOpen() const {
+#ifdef _WIN32
+            return m_File != INVALID_HANDLE_VALUE;
+#else
+            return m_Descriptor >= 0;
+#endif
+        }
+
+        const char *Data() const { return m_Data; }
+        size_t Size() const { return m_Size; }
+        std::string_view View() const { return {m_Data == nullptr ? "" : m_Data, m_Size}; }
+
+    private:
+        void swap(MappedFile &other) {
+            std::swap(m_Data, other.m_Data);
+            std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+            std::swap(m_File, other.m_File);
+            std::swap(m_Mapping, other.m_Mapping);
+#else
+            std::swap(m_Descriptor, other.m_Descriptor);
+#endif
+        }
+};
\ No newline at end of file
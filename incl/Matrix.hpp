@@ -1,87 +1,201 @@
 #pragma once
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "AlignedAllocator.hpp"
 #include "literals.hpp"
 
+constexpr size_t MATRIX_ALIGNMENT = 64;
+
+/**
+ * @brief Non-owning view of a rectangular block of rows that are `stride`
+ * elements apart, e.g. a tile of a Matrix.
+ *
+ * @tparam T element data type, const for read-only views
+ */
+template <typename T> class MatrixView {
+    private:
+        T *m_Data = nullptr;
+        size_t m_Rows = 0;
+        size_t m_Cols = 0;
+        size_t m_Stride = 0;
+
+    public:
+        MatrixView() {}
+        MatrixView(T *data, size_t rows, size_t cols, size_t stride)
+            : m_Data(data), m_Rows(rows), m_Cols(cols), m_Stride(stride) {}
+
+        size_t numRows() const { return m_Rows; }
+        size_t numCols() const { return m_Cols; }
+        size_t Stride() const { return m_Stride; }
+
+        std::span<T> Row(size_t idx) const { return {m_Data + idx * m_Stride, m_Cols}; }
+        T &At(size_t row, size_t col) const { return m_Data[row * m_Stride + col]; }
+};
+
 /**
- * @brief A primitve square matrix class, does not implement bound checking.
+ * @brief A primitive matrix class over one flat, row-major allocation. Every row
+ * starts on a MATRIX_ALIGNMENT boundary (rows are padded to a whole number of
+ * cache lines whenever sizeof(T) allows it), so the bulk operations below
+ * compile to aligned SIMD loops. Only the checked accessors do bound checking.
  *
  * @tparam T contained element data type
  */
 template <typename T> class Matrix {
     private:
-        std::vector<std::vector<T>> m_Matrix;
+        // rows can only be padded to full cache lines if whole elements fit into one
+        static constexpr bool ALIGNED_ROWS = MATRIX_ALIGNMENT % sizeof(T) == 0;
+
+        std::vector<T, AlignedAllocator<T, MATRIX_ALIGNMENT>> m_Data;
+        size_t m_Rows = 0;
+        size_t m_Cols = 0;
+        size_t m_Stride = 0;
 
     public:
         Matrix() {}
-        Matrix(const Matrix &other) : m_Matrix(other.m_Matrix) {}
-        Matrix(Matrix &&other) : m_Matrix(other.m_Matrix) { other.m_Matrix.clear(); }
-        Matrix(const std::vector<std::vector<T>> &obj) : m_Matrix(obj){};
+        Matrix(const Matrix &other) = default;
+        Matrix(Matrix &&other) noexcept
+            : m_Data(std::move(other.m_Data)), m_Rows(std::exchange(other.m_Rows, 0)),
+              m_Cols(std::exchange(other.m_Cols, 0)),
+              m_Stride(std::exchange(other.m_Stride, 0)) {}
+        Matrix(const std::vector<std::vector<T>> &obj) { *this = obj; }
         Matrix(const std::initializer_list<std::initializer_list<T>> &il) {
-            for (const std::initializer_list<T> &il_row : il) {
-                std::vector<T> row;
-
-                for (const T &elem : il_row)
-                    row.push_back(elem);
-
-                m_Matrix.push_back(row);
-            }
+            for (const std::initializer_list<T> &il_row : il)
+                AppendRow(std::vector<T>(il_row));
         }
-        Matrix(T value, size_t dim) {
-            for (size_t i = 0; i < dim; i++)
-                m_Matrix.push_back(std::vector<T>(dim, value));
+        Matrix(T value, size_t dim) : Matrix(value, dim, dim) {}
+        Matrix(T value, size_t rows, size_t cols) { reshape(rows, cols, value); }
+
+        Matrix &operator=(const Matrix &other) = default;
+        Matrix &operator=(Matrix &&other) noexcept {
+            m_Data = std::move(other.m_Data);
+            m_Rows = std::exchange(other.m_Rows, 0);
+            m_Cols = std::exchange(other.m_Cols, 0);
+            m_Stride = std::exchange(other.m_Stride, 0);
+            return *this;
         }
 
         Matrix &operator=(const std::vector<std::vector<T>> &other) {
-            m_Matrix = other;
+            reshape(0, other.empty() ? 0 : other.front().size(), T{});
+            for (const std::vector<T> &row : other)
+                AppendRow(row);
+
             return *this;
         }
 
-        Matrix &operator=(const std::vector<std::vector<T>> &other) const = delete;
-        Matrix &operator=(std::vector<std::vector<T>> other) const = delete;
+        // copies the rows back out, padding excluded
+        std::vector<std::vector<T>> ToVectors() const {
+            std::vector<std::vector<T>> result;
+            for (size_t i = 0; i < m_Rows; i++)
+                result.emplace_back(Row(i).begin(), Row(i).end());
+
+            return result;
+        }
+
+        size_t numRows() const { return m_Rows; }
+        size_t numCols() const { return m_Cols; }
 
-        std::vector<std::vector<T>> &get() { return m_Matrix; }
-        const std::vector<std::vector<T>> &get() const { return m_Matrix; }
+        // distance between the starts of two consecutive rows, in elements
+        size_t Stride() const { return m_Stride; }
+        T *Data() { return m_Data.data(); }
+        const T *Data() const { return m_Data.data(); }
 
-        size_t numRows() const { return m_Matrix.size(); }
-        size_t numRows() { return m_Matrix.size(); }
-        size_t numCols() const { return m_Matrix.at(0).size(); }
-        size_t numCols() { return m_Matrix.at(0).size(); }
+        std::span<T> Row(size_t idx) { return {row_data(idx), m_Cols}; }
+        std::span<const T> Row(size_t idx) const { return {row_data(idx), m_Cols}; }
+
+        MatrixView<T> View() { return {Data(), m_Rows, m_Cols, m_Stride}; }
+        MatrixView<const T> View() const { return {Data(), m_Rows, m_Cols, m_Stride}; }
+
+        // rows x cols block starting at (row, col), clipped to the matrix
+        MatrixView<T> Block(size_t row, size_t col, size_t rows, size_t cols) {
+            return {Data() + row * m_Stride + col, clip(row, rows, m_Rows),
+                    clip(col, cols, m_Cols), m_Stride};
+        }
+
+        MatrixView<const T> Block(size_t row, size_t col, size_t rows, size_t cols) const {
+            return {Data() + row * m_Stride + col, clip(row, rows, m_Rows),
+                    clip(col, cols, m_Cols), m_Stride};
+        }
+
+        void AppendRow(std::vector<T> row) {
+            if (m_Rows == 0 && m_Cols == 0)
+                reshape(0, row.size(), T{});
+            else if (row.size() != m_Cols)
+                throw(std::invalid_argument("expected a row of " + std::to_string(m_Cols) +
+                                            " elements, got " + std::to_string(row.size())));
+
+            m_Data.resize((m_Rows + 1) * m_Stride, T{});
+            std::copy(row.begin(), row.end(), row_data(m_Rows++));
+        }
 
-        void AppendRow(std::vector<T> row) { m_Matrix.push_back(row); }
         void Fill(const T &value) {
-            for (std::vector<T> &row : m_Matrix)
-                for (T &element : row)
-                    element = value;
+            for (size_t i = 0; i < m_Rows; i++) {
+                T *row = row_data(i);
+                for (size_t j = 0; j < m_Cols; j++)
+                    row[j] = value;
+            }
         }
 
-        std::vector<T> &operator[](size_t idx) {
-            if (idx > m_Matrix.size())
+        // elementwise this = min(this, other)
+        void Min(const Matrix &other) {
+            check_shape(other);
+            for (size_t i = 0; i < m_Rows; i++) {
+                T *row = row_data(i);
+                const T *src = other.row_data(i);
+                for (size_t j = 0; j < m_Cols; j++)
+                    row[j] = src[j] < row[j] ? src[j] : row[j];
+            }
+        }
+
+        // elementwise this += other
+        void Add(const Matrix &other) {
+            check_shape(other);
+            for (size_t i = 0; i < m_Rows; i++) {
+                T *row = row_data(i);
+                const T *src = other.row_data(i);
+                for (size_t j = 0; j < m_Cols; j++)
+                    row[j] += src[j];
+            }
+        }
+
+        T RowMin(size_t idx) const {
+            return reduce_row(idx, [](T a, T b) { return b < a ? b : a; });
+        }
+
+        T RowSum(size_t idx) const {
+            return reduce_row(idx, [](T a, T b) { return a + b; });
+        }
+
+        std::span<T> operator[](size_t idx) {
+            if (idx >= m_Rows)
                 throw(std::out_of_range(std::to_string(idx)));
 
-            return m_Matrix.at(idx);
+            return Row(idx);
         }
 
-        const std::vector<T> &operator[](size_t idx) const {
-            if (idx > m_Matrix.size())
+        std::span<const T> operator[](size_t idx) const {
+            if (idx >= m_Rows)
                 throw(std::out_of_range(std::to_string(idx)));
 
-            return m_Matrix.at(idx);
+            return Row(idx);
         }
 
         // https://stackoverflow.com/a/6969904
         class Proxy {
             private:
-                std::vector<T> &_arr;
+                std::span<T> _arr;
 
             public:
-                Proxy(std::vector<T> &arr) : _arr(arr) {}
+                Proxy(std::span<T> arr) : _arr(arr) {}
                 T &operator[](size_t idx) {
-                    if (idx <= _arr.size())
+                    if (idx < _arr.size())
                         return _arr[idx];
 
                     else
@@ -89,12 +203,12 @@ template <typename T> class Matrix {
                 }
         };
 
-        std::vector<T> &At(size_t idx) { return m_Matrix.at(idx); }
-        const std::vector<T> &At(size_t idx) const { return m_Matrix.at(idx); }
+        std::span<T> At(size_t idx) { return (*this)[idx]; }
+        std::span<const T> At(size_t idx) const { return (*this)[idx]; }
 
         Proxy operator[](int idx) {
             try {
-                return Proxy(m_Matrix.at(idx));
+                return Proxy((*this)[(size_t)idx]);
             } catch (const std::out_of_range &e) {
                 std::cout << e.what() << std::endl;
                 std::exit(EXIT_FAILURE);
@@ -102,8 +216,8 @@ template <typename T> class Matrix {
         }
 
         friend std::ostream &operator<<(std::ostream &os, const Matrix &obj) {
-            for (const auto &row : obj.get()) {
-                for (const T &elem : row)
+            for (size_t i = 0; i < obj.numRows(); i++) {
+                for (const T &elem : obj.Row(i))
                     os << std::setw(5) << std::left << elem << " ";
 
                 os << std::endl;
@@ -111,4 +225,67 @@ template <typename T> class Matrix {
 
             return os << '\b';
         }
+
+    private:
+        T *row_data(size_t idx) { return assume_aligned(m_Data.data() + idx * m_Stride); }
+        const T *row_data(size_t idx) const {
+            return assume_aligned(m_Data.data() + idx * m_Stride);
+        }
+
+        template <typename P> static P *assume_aligned(P *data) {
+            if constexpr (ALIGNED_ROWS)
+                return std::assume_aligned<MATRIX_ALIGNMENT>(data);
+            else
+                return data;
+        }
+
+        static size_t clip(size_t begin, size_t count, size_t size) {
+            return begin >= size ? 0 : std::min(count, size - begin);
+        }
+
+        void reshape(size_t rows, size_t cols, const T &value) {
+            const size_t perLine = ALIGNED_ROWS ? MATRIX_ALIGNMENT / sizeof(T) : 1;
+
+            m_Rows = rows;
+            m_Cols = cols;
+            m_Stride = (cols + perLine - 1) / perLine * perLine;
+            m_Data.assign(rows * m_Stride, T{});
+            Fill(value);
+        }
+
+        void check_shape(const Matrix &other) const {
+            if (other.m_Rows != m_Rows || other.m_Cols != m_Cols)
+                throw(std::invalid_argument("matrix shapes differ"));
+        }
+
+        // independent accumulators let the compiler keep one per SIMD lane
+        template <typename Op> T reduce_row(size_t idx, Op op) const {
+            constexpr size_t LANES = ALIGNED_ROWS ? MATRIX_ALIGNMENT / sizeof(T) : 1;
+            if (idx >= m_Rows || m_Cols == 0)
+                throw(std::out_of_range(std::to_string(idx)));
+
+            const T *row = row_data(idx);
+            size_t j = 0;
+            T result = row[0];
+
+            if (m_Cols >= 2 * LANES) {
+                T lanes[LANES];
+                std::copy(row, row + LANES, lanes);
+
+                for (j = LANES; j + LANES <= m_Cols; j += LANES)
+                    for (size_t l = 0; l < LANES; l++)
+                        lanes[l] = op(lanes[l], row[j + l]);
+
+                result = lanes[0];
+                for (size_t l = 1; l < LANES; l++)
+                    result = op(result, lanes[l]);
+            } else {
+                j = 1;
+            }
+
+            for (; j < m_Cols; j++)
+                result = op(result, row[j]);
+
+            return result;
+        }
 };
\ No newline at end of file
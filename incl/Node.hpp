@@ -1,8 +1,10 @@
 #pragma once
 
 #include "literals.hpp"
+#include <functional>
 #include <iostream>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -17,14 +19,17 @@ template <typename T> class Node {
 
         Node(const T &data) { m_Data = data; }
 
+        // e.g. a string node from the std::string_view that Graph hands out
+        template <typename U>
+            requires(!std::is_convertible_v<U, T> && std::is_constructible_v<T, U>)
+        explicit Node(U &&data) : m_Data(std::forward<U>(data)) {}
+
         Node(const Node &other) { m_Data = other.m_Data; }
 
-        Node(Node &&other) {
-            m_Data = other.m_Data;
-            other.m_Data = T{};
-        }
+        // moves the payload out, so moving a string node does not copy its characters
+        Node(Node &&other) noexcept : m_Data(std::move(other.m_Data)) { other.m_Data = T{}; }
 
-        T GetData() const { return m_Data; }
+        const T &GetData() const { return m_Data; }
         T &GetData() { return m_Data; }
 
         void SetData(const T &data) { m_Data = data; }
@@ -39,10 +44,8 @@ template <typename T> class Node {
         bool operator!=(const Node &other) const { return m_Data != other.m_Data; }
         bool operator!=(Node other) { return m_Data != other.m_Data; }
 
-        bool operator<(const Node &other) const {
-            return sizeof(m_Data) < sizeof(other.m_Data);
-        }
-        bool operator<(Node other) { return sizeof(m_Data) < sizeof(other.m_Data); }
+        bool operator<(const Node &other) const { return m_Data < other.m_Data; }
+        bool operator<(Node other) { return m_Data < other.m_Data; }
 
         void erase() { m_Data = T{}; }
 
@@ -51,6 +54,15 @@ template <typename T> class Node {
 
             return *this;
         }
+
+        Node<T> &operator=(Node<T> &&other) noexcept {
+            if (this != &other) {
+                m_Data = std::move(other.m_Data);
+                other.m_Data = T{};
+            }
+
+            return *this;
+        }
 };
 
 // namespace std {
@@ -65,7 +77,6 @@ template <typename T> class Node {
 template <typename T> class NodeHash {
     public:
         size_t operator()(const Node<T> &obj) const {
-            return (std::hash<size_t>()(sizeof(obj.GetData())) ^
-                    std::hash<size_t>()(sizeof(obj.GetData())));
+            return std::hash<T>()(obj.GetData());
         }
 };
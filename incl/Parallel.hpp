@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Resolves a requested worker count, 0 meaning "one per hardware thread".
+ */
+inline size_t ResolveThreadCount(size_t requested) {
+    if (requested > 0)
+        return requested;
+
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief The index space of one parallel loop, split evenly up front. A worker
+ * takes `grain` indices at a time from the front of its own range; once that is
+ * exhausted it steals the back half of another worker's remaining range, so uneven
+ * task costs (e.g. sources in a large component next to isolated ones) still
+ * balance out. The first exception thrown by body is kept for Rethrow.
+ */
+template <typename Body> class RangeSplit {
+    private:
+        struct alignas(64) Range {
+                std::mutex lock;
+                size_t begin = 0;
+                size_t end = 0;
+        };
+
+        Body &m_Body;
+        size_t m_ThreadCount;
+        size_t m_Grain;
+        std::unique_ptr<Range[]> m_Ranges;
+        std::mutex m_ErrorLock;
+        std::exception_ptr m_Error;
+
+    public:
+        RangeSplit(size_t count, size_t threadCount, Body &body, size_t grain)
+            : m_Body(body), m_ThreadCount(threadCount), m_Grain(grain),
+              m_Ranges(new Range[threadCount]) {
+            for (size_t w = 0; w < threadCount; w++) {
+                m_Ranges[w].begin = count * w / threadCount;
+                m_Ranges[w].end = count * (w + 1) / threadCount;
+            }
+        }
+
+        // runs indices as worker `id` until no range has any left
+        void Work(size_t id) {
+            Range &own = m_Ranges[id];
+
+            while (true) {
+                size_t begin = 0, end = 0;
+                {
+                    std::lock_guard<std::mutex> guard(own.lock);
+                    begin = own.begin;
+                    end = std::min(own.begin + m_Grain, own.end);
+                    own.begin = std::max(begin, end);
+                }
+
+                if (begin < end) {
+                    try {
+                        for (size_t i = begin; i < end; i++)
+                            m_Body(i, id);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guard(m_ErrorLock);
+                        if (!m_Error)
+                            m_Error = std::current_exception();
+                    }
+
+                    continue;
+                }
+
+                if (!steal(own, id))
+                    return;
+            }
+        }
+
+        void Rethrow() {
+            if (m_Error)
+                std::rethrow_exception(m_Error);
+        }
+
+    private:
+        bool steal(Range &own, size_t id) {
+            for (size_t k = 1; k < m_ThreadCount; k++) {
+                Range &victim = m_Ranges[(id + k) % m_ThreadCount];
+                size_t stolenBegin = 0, stolenEnd = 0;
+                {
+                    std::lock_guard<std::mutex> guard(victim.lock);
+                    if (victim.begin >= victim.end)
+                        continue;
+
+                    size_t take = (victim.end - victim.begin + 1) / 2;
+                    stolenEnd = victim.end;
+                    stolenBegin = victim.end - take;
+                    victim.end = stolenBegin;
+                }
+
+                std::lock_guard<std::mutex> guard(own.lock);
+                own.begin = stolenBegin;
+                own.end = stolenEnd;
+                return true;
+            }
+
+            return false;
+        }
+};
+
+/**
+ * @brief Persistent worker threads for parallel loops. Threads are started the
+ * first time a loop needs them and then wait for the next loop instead of exiting,
+ * so whatever they keep in thread_local storage (e.g. the ShortestPaths
+ * workspaces) survives from one call to the next. One loop runs at a time; a loop
+ * started from inside a pool worker runs serially on that worker.
+ */
+class WorkerPool {
+    private:
+        std::mutex m_RunLock; // held for a whole loop
+        std::mutex m_Lock;
+        std::condition_variable m_Wake;
+        std::condition_variable m_Idle;
+        std::vector<std::thread> m_Threads; // worker i + 1
+        const std::function<void(size_t)> *m_Task = nullptr;
+        size_t m_Participants = 0; // workers 1 .. m_Participants - 1 run m_Task
+        size_t m_Running = 0;
+        uint64_t m_Generation = 0;
+        bool m_Stopping = false;
+
+        static bool &inside_worker() {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+    public:
+        WorkerPool() {}
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> guard(m_Lock);
+                m_Stopping = true;
+            }
+            m_Wake.notify_all();
+            for (std::thread &thread : m_Threads)
+                thread.join();
+        }
+
+        WorkerPool(const WorkerPool &other) = delete;
+        WorkerPool &operator=(const WorkerPool &other) = delete;
+
+        // the pool behind ParallelFor
+        static WorkerPool &Shared() {
+            static WorkerPool pool;
+            return pool;
+        }
+
+        /**
+         * @brief Runs body(index, worker) for every index in [0, count) on threadCount
+         * workers (0 = one per hardware thread), the calling thread being worker 0.
+         * See RangeSplit for how indices are handed out; the first exception thrown
+         * by body is rethrown after all workers have stopped.
+         */
+        template <typename Body>
+        void For(size_t count, size_t threadCount, Body &&body, size_t grain = 1) {
+            threadCount = std::min(ResolveThreadCount(threadCount), std::max<size_t>(count, 1));
+            grain = std::max<size_t>(grain, 1);
+
+            if (threadCount == 1 || inside_worker()) {
+                for (size_t i = 0; i < count; i++)
+                    body(i, 0);
+
+                return;
+            }
+
+            RangeSplit<Body> split(count, threadCount, body, grain);
+            const std::function<void(size_t)> task = [&](size_t id) { split.Work(id); };
+
+            std::lock_guard<std::mutex> run(m_RunLock);
+            start(threadCount, task);
+            inside_worker() = true;
+            split.Work(0);
+            inside_worker() = false;
+
+            std::unique_lock<std::mutex> guard(m_Lock);
+            m_Idle.wait(guard, [&] { return m_Running == 0; });
+            m_Task = nullptr;
+            guard.unlock();
+
+            split.Rethrow();
+        }
+
+    private:
+        void start(size_t threadCount, const std::function<void(size_t)> &task) {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            while (m_Threads.size() + 1 < threadCount) {
+                const size_t id = m_Threads.size() + 1;
+                m_Threads.emplace_back([this, id] { work(id); });
+            }
+
+            m_Task = &task;
+            m_Participants = threadCount;
+            m_Running = threadCount - 1;
+            m_Generation++;
+            m_Wake.notify_all();
+        }
+
+        void work(size_t id) {
+            inside_worker() = true;
+            uint64_t seen = 0;
+
+            std::unique_lock<std::mutex> guard(m_Lock);
+            while (true) {
+                m_Wake.wait(guard, [&] {
+                    return m_Stopping || (m_Generation != seen && id < m_Participants);
+                });
+                if (m_Stopping)
+                    return;
+
+                seen = m_Generation;
+                const std::function<void(size_t)> &task = *m_Task;
+                guard.unlock();
+                task(id);
+                guard.lock();
+
+                if (--m_Running == 0)
+                    m_Idle.notify_one();
+            }
+        }
+};
+
+/**
+ * @brief Runs body(index, worker) for every index in [0, count) on threadCount
+ * workers of the shared WorkerPool, the calling thread being worker 0. See
+ * WorkerPool::For.
+ */
+template <typename Body>
+void ParallelFor(size_t count, size_t threadCount, Body &&body, size_t grain = 1) {
+    WorkerPool::Shared().For(count, threadCount, std::forward<Body>(body), grain);
+}
\ No newline at end of file
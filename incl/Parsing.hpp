@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "literals.hpp"
+
+/**
+ * @brief Iterates the lines of an in-memory text buffer without copying them.
+ * Both "\n" and "\r\n" endings are accepted; the terminator is never part of the
+ * returned line.
+ */
+class LineCursor {
+    private:
+        std::string_view m_Text;
+        size_t m_Position = 0;
+        size_t m_LineNumber = 0;
+
+    public:
+        LineCursor() {}
+        LineCursor(std::string_view text) : m_Text(text) {}
+
+        bool Next(std::string_view &line) {
+            if (m_Position >= m_Text.size())
+                return false;
+
+            size_t end = m_Text.find('\n', m_Position);
+            if (end == std::string_view::npos)
+                end = m_Text.size();
+
+            line = m_Text.substr(m_Position, end - m_Position);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+
+            m_Position = end + 1;
+            m_LineNumber++;
+            return true;
+        }
+
+        // 1-based number of the line last returned by Next
+        size_t LineNumber() const { return m_LineNumber; }
+        size_t Position() const { return m_Position; }
+};
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+/**
+ * @brief Pops the next whitespace-delimited token off the front of line, returns
+ * an empty view once the line is exhausted.
+ */
+inline std::string_view NextToken(std::string_view &line) {
+    size_t begin = 0;
+    while (begin < line.size() && IsBlank(line[begin]))
+        begin++;
+
+    size_t end = begin;
+    while (end < line.size() && !IsBlank(line[end]))
+        end++;
+
+    std::string_view token = line.substr(begin, end - begin);
+    line.remove_prefix(end);
+    return token;
+}
+
+/**
+ * @brief Parses the whole token as a number with std::from_chars, no locale, no
+ * allocation. Returns false if the token is empty, malformed or has trailing junk.
+ */
+template <typename N> bool ParseNumber(std::string_view token, N &value) {
+    if (!token.empty() && token.front() == '+')
+        token.remove_prefix(1);
+
+    auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return error == std::errc() && end == token.data() + token.size() && !token.empty();
+}
+
+/**
+ * @brief Parses an edge weight. Integer weight types are fixed-point (see
+ * ToWeight), so "0.35" becomes 35; a score that does not fit counts as malformed.
+ */
+template <typename W> bool ParseWeight(std::string_view token, W &value) {
+    if constexpr (std::is_integral_v<W>) {
+        double score;
+        if (!ParseNumber(token, score) || !WeightFits<W>(score))
+            return false;
+
+        value = ToWeight<W>(score);
+        return true;
+    } else {
+        return ParseNumber(token, value);
+    }
+}
+
+/**
+ * @brief Converts a token into a node payload: strings are copied, arithmetic
+ * payloads are parsed.
+ */
+template <typename T> T ParseSymbol(std::string_view token) {
+    if constexpr (std::is_constructible_v<T, std::string_view>) {
+        return T(token);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        T value{};
+        if (!ParseNumber(token, value))
+            throw(std::invalid_argument(std::string(token)));
+
+        return value;
+    } else {
+        return T(std::string(token));
+    }
+}
+
+/**
+ * @brief Splits text into at most `count` consecutive pieces that each end right
+ * after a '\n' (or at the end of text), so every piece holds whole lines.
+ */
+inline std::vector<std::string_view> SplitLines(std::string_view text, size_t count) {
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+
+    for (size_t i = 1; i <= count && begin < text.size(); i++) {
+        size_t end = i == count ? text.size()
+                                : text.find('\n', std::max(begin, text.size() * i / count));
+        end = end >= text.size() ? text.size() : end + 1;
+
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return chunks;
+}
+
+// 1-based line number of the character at `where` inside text, for error messages
+inline size_t LineOf(std::string_view text, const char *where) {
+    size_t offset = std::min<size_t>(where - text.data(), text.size());
+    return 1 + std::count(text.begin(), text.begin() + offset, '\n');
+}
+
+inline std::runtime_error ParseError(const std::string &filename, size_t line,
+                                     const std::string &message) {
+    return std::runtime_error(filename + ":" + std::to_string(line) + ": " + message);
+}
\ No newline at end of file
@@ -0,0 +1,571 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Parallel.hpp"
+
+/**
+ * @brief Wire format of the query server, over a Unix stream socket. Every message
+ * is a frame: a 4-byte little-endian payload length, then the payload.
+ *
+ * A request payload is one command line as main's batch mode reads it, e.g.
+ * "knn A 5". A response payload is a status byte (FRAME_OK or FRAME_ERROR), the
+ * server-side latency of the request as a 4-byte little-endian count of
+ * microseconds, then the answer text. Requests may be pipelined; the responses of a
+ * connection come back in request order.
+ */
+constexpr uint8_t FRAME_OK = 0;
+constexpr uint8_t FRAME_ERROR = 1;
+constexpr size_t FRAME_HEADER = 4;
+constexpr size_t RESPONSE_HEADER = 5;
+constexpr size_t FRAME_LIMIT = 1 << 20; // longer requests close the connection
+
+inline void AppendU32(std::string &out, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+        out += (char)((value >> (8 * i)) & 0xff);
+}
+
+inline uint32_t ReadU32(const char *data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (uint32_t)(uint8_t)data[i] << (8 * i);
+
+    return value;
+}
+
+inline void AppendFrame(std::string &out, std::string_view payload) {
+    AppendU32(out, (uint32_t)payload.size());
+    out += payload;
+}
+
+/**
+ * @brief Request latencies in power-of-two buckets of microseconds, so percentiles
+ * are reported as the upper bound of their bucket.
+ */
+struct LatencyStats {
+        static constexpr size_t BUCKETS = 40;
+
+        uint64_t requests = 0;
+        uint64_t errors = 0;
+        uint64_t totalMicros = 0;
+        uint64_t maxMicros = 0;
+        uint64_t buckets[BUCKETS] = {}; // bucket b holds latencies below 2^b us
+
+        void Add(uint64_t micros, bool error) {
+            requests++;
+            errors += error;
+            totalMicros += micros;
+            maxMicros = std::max(maxMicros, micros);
+            buckets[std::min<size_t>(std::bit_width(micros), BUCKETS - 1)]++;
+        }
+
+        uint64_t Percentile(double fraction) const {
+            const uint64_t rank = (uint64_t)(fraction * requests);
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; b++) {
+                seen += buckets[b];
+                if (seen > rank)
+                    return std::min(maxMicros, ((uint64_t)1 << b) - 1);
+            }
+
+            return maxMicros;
+        }
+
+        std::string ToJson() const {
+            std::string json = "{\"requests\": " + std::to_string(requests);
+            json += ", \"errors\": " + std::to_string(errors);
+            json += ", \"mean_us\": " + std::to_string(requests ? totalMicros / requests : 0);
+            json += ", \"p50_us\": " + std::to_string(Percentile(0.5));
+            json += ", \"p99_us\": " + std::to_string(Percentile(0.99));
+            return json + ", \"max_us\": " + std::to_string(maxMicros) + "}";
+        }
+};
+
+/**
+ * @brief Long-lived query server on a Unix domain socket. One event-loop thread
+ * polls the listening socket and every connection, cuts complete request frames
+ * out of the input and queues them; a pool of workers runs the handler on them and
+ * hands the responses back through a wake pipe, and the loop writes them out in
+ * request order. The handler is called from several workers at once, so it must
+ * only read shared state, and throws to answer with FRAME_ERROR and e.what().
+ */
+class QueryServer {
+    public:
+        using Handler = std::function<void(std::string_view request, std::string &answer)>;
+
+        // a connection with this many unanswered requests is not read until some
+        // of them are answered
+        static constexpr size_t PENDING_LIMIT = 4096;
+        static constexpr auto REPORT_INTERVAL = std::chrono::seconds(10);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Connection {
+                int fd = -1;
+                std::string input;
+                std::string output;
+                size_t written = 0;           // bytes of output already sent
+                uint64_t nextSequence = 0;    // given to the next request read
+                uint64_t sendSequence = 0;    // the next response to append to output
+                std::map<uint64_t, std::string> finished; // responses waiting for order
+                bool closing = false;         // peer hung up, drop once answered
+        };
+
+        struct Job {
+                uint64_t connection;
+                uint64_t sequence;
+                std::string request;
+                Clock::time_point arrival;
+        };
+
+        struct Done {
+                uint64_t connection;
+                uint64_t sequence;
+                std::string frame;
+                uint64_t micros;
+                bool error;
+        };
+
+        std::string m_Path;
+        Handler m_Handler;
+        size_t m_ThreadCount;
+        int m_Listen = -1;
+        int m_Wake[2] = {-1, -1};
+
+        std::unordered_map<uint64_t, Connection> m_Connections;
+        uint64_t m_NextConnection = 0;
+
+        std::mutex m_JobLock;
+        std::condition_variable m_JobReady;
+        std::deque<Job> m_Jobs;
+        bool m_Stopping = false;
+
+        std::mutex m_DoneLock;
+        std::vector<Done> m_Done;
+
+        LatencyStats m_Total, m_Window;
+        std::vector<std::thread> m_Workers;
+
+    public:
+        // binds path (replacing a stale socket file) and starts listening; the
+        // workers start with Run
+        QueryServer(std::string path, Handler handler, size_t threads = 0)
+            : m_Path(std::move(path)), m_Handler(std::move(handler)),
+              m_ThreadCount(ResolveThreadCount(threads)) {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (m_Path.size() >= sizeof(address.sun_path))
+                throw(std::invalid_argument("socket path too long: " + m_Path));
+            std::memcpy(address.sun_path, m_Path.c_str(), m_Path.size() + 1);
+
+            if (pipe(m_Wake) != 0)
+                throw(std::runtime_error("cannot create the wake pipe"));
+            set_nonblocking(m_Wake[0]);
+            set_nonblocking(m_Wake[1]);
+
+            m_Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            unlink(m_Path.c_str());
+            if (m_Listen < 0 || bind(m_Listen, (sockaddr *)&address, sizeof(address)) != 0 ||
+                listen(m_Listen, SOMAXCONN) != 0) {
+                std::string message = "cannot listen on " + m_Path + ": " + std::strerror(errno);
+                close_all();
+                throw(std::runtime_error(message));
+            }
+            set_nonblocking(m_Listen);
+        }
+
+        ~QueryServer() {
+            stop_workers();
+            close_all();
+        }
+
+        QueryServer(const QueryServer &other) = delete;
+        QueryServer &operator=(const QueryServer &other) = delete;
+
+        // serves until Stop; returns (or throws) once the workers have stopped
+        void Run() {
+            struct WorkerGuard {
+                    QueryServer &server;
+                    ~WorkerGuard() { server.stop_workers(); }
+            } workerGuard{*this};
+
+            m_Stopping = false;
+            for (size_t w = 0; w < m_ThreadCount; w++)
+                m_Workers.emplace_back([this] { work(); });
+
+            Clock::time_point lastReport = Clock::now();
+            std::vector<pollfd> fds;
+            std::vector<uint64_t> ids; // connection behind fds[i + 2]
+
+            while (true) {
+                fds.assign({{m_Wake[0], POLLIN, 0}, {m_Listen, POLLIN, 0}});
+                ids.clear();
+                for (auto &[id, connection] : m_Connections) {
+                    short events = 0;
+                    if (!connection.closing &&
+                        connection.nextSequence - connection.sendSequence < PENDING_LIMIT)
+                        events |= POLLIN;
+                    if (connection.written < connection.output.size())
+                        events |= POLLOUT;
+
+                    fds.push_back({connection.fd, events, 0});
+                    ids.push_back(id);
+                }
+
+                const int timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        REPORT_INTERVAL)
+                                        .count();
+                if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+                    throw(std::runtime_error(std::string("poll: ") + std::strerror(errno)));
+
+                if (fds[0].revents & POLLIN) {
+                    char drain[256];
+                    bool stop = false;
+                    for (ssize_t n; (n = read(m_Wake[0], drain, sizeof(drain))) > 0;)
+                        stop |= std::memchr(drain, 's', n) != nullptr;
+
+                    collect();
+                    if (stop)
+                        break;
+                }
+
+                if (fds[1].revents & POLLIN)
+                    accept_all();
+
+                for (size_t i = 0; i < ids.size(); i++) {
+                    auto it = m_Connections.find(ids[i]);
+                    Connection &connection = it->second;
+                    if (fds[i + 2].revents & (POLLHUP | POLLERR))
+                        drop(connection); // nothing can be written back any more
+                    if (connection.fd >= 0 && (fds[i + 2].revents & POLLIN))
+                        receive(it->first, connection);
+                    if (connection.fd >= 0 && (fds[i + 2].revents & POLLOUT))
+                        send(connection);
+
+                    if (connection.fd < 0 ||
+                        (connection.closing && connection.sendSequence == connection.nextSequence &&
+                         connection.written == connection.output.size())) {
+                        drop(connection);
+                        m_Connections.erase(it);
+                    }
+                }
+
+                if (Clock::now() - lastReport >= REPORT_INTERVAL) {
+                    if (m_Window.requests > 0)
+                        report("window", m_Window);
+                    m_Window = LatencyStats();
+                    lastReport = Clock::now();
+                }
+            }
+
+            stop_workers();
+            report("total", m_Total);
+        }
+
+        // makes Run return; only writes to a pipe, so it is safe in a signal handler
+        void Stop() {
+            const char stop = 's';
+            [[maybe_unused]] ssize_t written = write(m_Wake[1], &stop, 1);
+        }
+
+        const LatencyStats &GetStats() const { return m_Total; }
+
+    private:
+        static void set_nonblocking(int fd) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        void stop_workers() {
+            {
+                std::lock_guard<std::mutex> guard(m_JobLock);
+                m_Stopping = true;
+            }
+            m_JobReady.notify_all();
+            for (std::thread &worker : m_Workers)
+                worker.join();
+            m_Workers.clear();
+        }
+
+        static void report(const char *label, const LatencyStats &stats) {
+            std::string line = std::string("[server] ") + label + " " + stats.ToJson() + "\n";
+            [[maybe_unused]] ssize_t written = write(STDERR_FILENO, line.data(), line.size());
+        }
+
+        static void drop(Connection &connection) {
+            if (connection.fd >= 0)
+                ::close(connection.fd);
+            connection.fd = -1;
+        }
+
+        void close_all() {
+            for (auto &[id, connection] : m_Connections)
+                drop(connection);
+            m_Connections.clear();
+
+            for (int *fd : {&m_Listen, &m_Wake[0], &m_Wake[1]}) {
+                if (*fd >= 0)
+                    ::close(*fd);
+                *fd = -1;
+            }
+
+            if (!m_Path.empty())
+                unlink(m_Path.c_str());
+            m_Path.clear();
+        }
+
+        void accept_all() {
+            for (int fd; (fd = accept(m_Listen, nullptr, nullptr)) >= 0;) {
+                set_nonblocking(fd);
+                m_Connections[m_NextConnection++].fd = fd;
+            }
+        }
+
+        // reads what is available (up to about a frame's worth, so that one busy
+        // connection cannot starve the others) and queues every complete frame in it;
+        // a peer that shuts down its side still gets the answers it is owed
+        void receive(uint64_t id, Connection &connection) {
+            char buffer[64 * 1024];
+            ssize_t n = 0;
+            while (connection.input.size() <= FRAME_LIMIT &&
+                   (n = read(connection.fd, buffer, sizeof(buffer))) > 0)
+                connection.input.append(buffer, n);
+
+            if (n == 0)
+                connection.closing = true;
+            else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                return drop(connection);
+
+            std::vector<Job> jobs;
+            const Clock::time_point now = Clock::now();
+            size_t offset = 0;
+            while (connection.input.size() - offset >= FRAME_HEADER) {
+                const size_t length = ReadU32(connection.input.data() + offset);
+                if (length > FRAME_LIMIT)
+                    return drop(connection);
+                if (connection.input.size() - offset - FRAME_HEADER < length)
+                    break;
+
+                jobs.push_back({id, connection.nextSequence++,
+                                connection.input.substr(offset + FRAME_HEADER, length), now});
+                offset += FRAME_HEADER + length;
+            }
+            connection.input.erase(0, offset);
+
+            if (jobs.empty())
+                return;
+
+            {
+                std::lock_guard<std::mutex> guard(m_JobLock);
+                for (Job &job : jobs)
+                    m_Jobs.push_back(std::move(job));
+            }
+            if (jobs.size() == 1)
+                m_JobReady.notify_one();
+            else
+                m_JobReady.notify_all();
+        }
+
+        void send(Connection &connection) {
+            while (connection.written < connection.output.size()) {
+                ssize_t n = ::send(connection.fd, connection.output.data() + connection.written,
+                                   connection.output.size() - connection.written, MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        drop(connection);
+                    return;
+                }
+
+                connection.written += n;
+            }
+
+            connection.output.clear();
+            connection.written = 0;
+        }
+
+        // moves finished responses into their connections' output, in request order
+        void collect() {
+            std::vector<Done> done;
+            {
+                std::lock_guard<std::mutex> guard(m_DoneLock);
+                done.swap(m_Done);
+            }
+
+            std::vector<Connection *> touched;
+            for (Done &response : done) {
+                m_Total.Add(response.micros, response.error);
+                m_Window.Add(response.micros, response.error);
+
+                auto it = m_Connections.find(response.connection);
+                if (it == m_Connections.end() || it->second.fd < 0)
+                    continue;
+
+                Connection &connection = it->second;
+                connection.finished.emplace(response.sequence, std::move(response.frame));
+                touched.push_back(&connection);
+            }
+
+            for (Connection *connection : touched) {
+                auto &finished = connection->finished;
+                for (auto it = finished.begin();
+                     it != finished.end() && it->first == connection->sendSequence;
+                     it = finished.erase(it)) {
+                    connection->output += it->second;
+                    connection->sendSequence++;
+                }
+
+                send(*connection);
+            }
+        }
+
+        void work() {
+            std::string answer;
+            while (true) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> guard(m_JobLock);
+                    m_JobReady.wait(guard, [&] { return m_Stopping || !m_Jobs.empty(); });
+                    if (m_Stopping)
+                        return;
+
+                    job = std::move(m_Jobs.front());
+                    m_Jobs.pop_front();
+                }
+
+                bool error = false;
+                answer.clear();
+                try {
+                    m_Handler(job.request, answer);
+                } catch (const std::exception &e) {
+                    answer = e.what();
+                    error = true;
+                }
+
+                const uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                            Clock::now() - job.arrival)
+                                            .count();
+
+                std::string frame;
+                frame.reserve(FRAME_HEADER + RESPONSE_HEADER + answer.size());
+                AppendU32(frame, (uint32_t)(RESPONSE_HEADER + answer.size()));
+                frame += (char)(error ? FRAME_ERROR : FRAME_OK);
+                AppendU32(frame, (uint32_t)std::min<uint64_t>(micros, UINT32_MAX));
+                frame += answer;
+
+                bool wake;
+                {
+                    std::lock_guard<std::mutex> guard(m_DoneLock);
+                    wake = m_Done.empty();
+                    m_Done.push_back(
+                        {job.connection, job.sequence, std::move(frame), micros, error});
+                }
+
+                // the loop drains every response queued so far on one wake-up
+                if (wake) {
+                    const char ready = 'r';
+                    [[maybe_unused]] ssize_t written = write(m_Wake[1], &ready, 1);
+                }
+            }
+        }
+};
+
+/**
+ * @brief Blocking client of QueryServer, one request at a time.
+ */
+class QueryClient {
+    private:
+        int m_Socket = -1;
+
+    public:
+        explicit QueryClient(const std::string &path) {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path))
+                throw(std::invalid_argument("socket path too long: " + path));
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+            m_Socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (m_Socket < 0 || connect(m_Socket, (sockaddr *)&address, sizeof(address)) != 0) {
+                if (m_Socket >= 0)
+                    ::close(m_Socket);
+                throw(std::runtime_error("cannot connect to " + path + ": " +
+                                         std::strerror(errno)));
+            }
+        }
+
+        ~QueryClient() {
+            if (m_Socket >= 0)
+                ::close(m_Socket);
+        }
+
+        QueryClient(const QueryClient &other) = delete;
+        QueryClient &operator=(const QueryClient &other) = delete;
+
+        // sends request and waits for its response; false if the server answered
+        // with FRAME_ERROR, answer then holds the message
+        bool Request(std::string_view request, std::string &answer, uint32_t *micros = nullptr) {
+            std::string frame;
+            AppendFrame(frame, request);
+            write_all(frame.data(), frame.size());
+
+            char header[FRAME_HEADER + RESPONSE_HEADER];
+            read_all(header, sizeof(header));
+            const size_t length = ReadU32(header);
+            if (length < RESPONSE_HEADER)
+                throw(std::runtime_error("malformed response frame"));
+
+            answer.resize(length - RESPONSE_HEADER);
+            read_all(answer.data(), answer.size());
+            if (micros)
+                *micros = ReadU32(header + FRAME_HEADER + 1);
+
+            return (uint8_t)header[FRAME_HEADER] == FRAME_OK;
+        }
+
+    private:
+        void write_all(const char *data, size_t size) {
+            while (size > 0) {
+                ssize_t n = ::send(m_Socket, data, size, MSG_NOSIGNAL);
+                if (n <= 0)
+                    throw(std::runtime_error("server closed the connection"));
+                data += n;
+                size -= n;
+            }
+        }
+
+        void read_all(char *data, size_t size) {
+            while (size > 0) {
+                ssize_t n = read(m_Socket, data, size);
+                if (n <= 0)
+                    throw(std::runtime_error("server closed the connection"));
+                data += n;
+                size -= n;
+            }
+        }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CSRGraph.hpp"
+#include "Heap.hpp"
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Heap-based Dijkstra over a CSRGraph.
+ *
+ * Paths are ordered by (weight, hops): Distance() is the least path weight and
+ * Hops() the fewest edges among the paths of that weight, both from the one run.
+ * The heap only orders by weight; an equal-weight path with fewer edges updates
+ * the hop count in place, and if it reaches a node that is already settled (only
+ * zero-weight edges can) the drop is spread to its equal-weight successors.
+ *
+ * Every query runs inside a Workspace that owns the distance/hop/parent arrays and
+ * the frontier heap. The arrays are validated by an epoch stamp instead of being
+ * cleared, so once a workspace has been sized for a graph, queries on it do not
+ * allocate. LocalWorkspace() hands out one workspace per thread.
+ *
+ * @tparam W edge weight data type; distances are PathWeightOf<W>, and paths of
+ * InfinityOf of that or more count as unreachable
+ * @tparam Heap addressable min-heap, see Heap.hpp (a radix heap for integer W)
+ */
+template <typename W = NodeWeight, typename Heap = DefaultHeap<PathWeightOf<W>>>
+class ShortestPaths {
+    public:
+        using PathWeight = PathWeightOf<W>;
+
+        class Workspace {
+                friend class ShortestPaths;
+
+            private:
+                std::vector<PathWeight> m_Distances;
+                std::vector<uint32_t> m_Hops;
+                std::vector<NodeID> m_Parents;
+                std::vector<uint32_t> m_Stamps;
+                std::vector<NodeID> m_Settled;
+                std::vector<PathWeight> m_Bound; // max-heap of the k best first-reach distances
+                std::vector<NodeID> m_Spread; // settled nodes whose hop count dropped
+                uint32_t m_Epoch = 0;
+                NodeID m_Source = INVALID_NODE;
+                Heap m_Heap;
+                SPA_STAT_ONLY(LocalCounters m_Counters;)
+
+            public:
+                Workspace() {}
+
+                NodeID Source() const { return m_Source; }
+                bool Reached(NodeID id) const { return m_Stamps[id] == m_Epoch; }
+
+                // a reached node is settled once it has left the frontier
+                bool Settled(NodeID id) const { return Reached(id) && !m_Heap.Contains(id); }
+
+                PathWeight Distance(NodeID id) const {
+                    return Reached(id) ? m_Distances[id] : InfinityOf<PathWeight>();
+                }
+
+                uint32_t Hops(NodeID id) const {
+                    return Reached(id) ? m_Hops[id] : InfinityOf<uint32_t>();
+                }
+
+                NodeID Parent(NodeID id) const {
+                    return Reached(id) ? m_Parents[id] : INVALID_NODE;
+                }
+
+                // settled nodes in the order they were popped, i.e. by ascending distance
+                const std::vector<NodeID> &Settled() const { return m_Settled; }
+
+                // node sequence source -> ... -> target, empty if target was not reached
+                std::vector<NodeID> PathTo(NodeID target) const {
+                    std::vector<NodeID> path;
+                    if (!Reached(target))
+                        return path;
+
+                    for (NodeID id = target; id != INVALID_NODE; id = m_Parents[id])
+                        path.push_back(id);
+
+                    std::reverse(path.begin(), path.end());
+                    return path;
+                }
+
+            private:
+                void prepare(size_t nodeCount, NodeID source) {
+                    if (m_Stamps.size() < nodeCount) {
+                        SPA_STAT_ADD(bytesAllocated,
+                                     (nodeCount - m_Stamps.size()) *
+                                         (sizeof(PathWeight) + 2 * sizeof(uint32_t) +
+                                          2 * sizeof(NodeID)));
+                        m_Distances.resize(nodeCount);
+                        m_Hops.resize(nodeCount);
+                        m_Parents.resize(nodeCount);
+                        m_Stamps.resize(nodeCount, 0);
+                        m_Settled.reserve(nodeCount);
+                    }
+
+                    if (++m_Epoch == 0) {
+                        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+                        m_Epoch = 1;
+                    }
+
+                    m_Settled.clear();
+                    m_Bound.clear();
+                    m_Heap.Reset(nodeCount);
+                    m_Source = source;
+                }
+
+                // k reached nodes already lie within the top of m_Bound and their
+                // distances only shrink, so a first reach beyond it can never make
+                // the k nearest and stays out of the frontier
+                bool admit(PathWeight distance, size_t k) {
+                    if (m_Bound.size() < k) {
+                        m_Bound.push_back(distance);
+                        std::push_heap(m_Bound.begin(), m_Bound.end());
+                        return true;
+                    }
+
+                    if (k == 0 || distance > m_Bound.front())
+                        return false;
+
+                    std::pop_heap(m_Bound.begin(), m_Bound.end());
+                    m_Bound.back() = distance;
+                    std::push_heap(m_Bound.begin(), m_Bound.end());
+                    return true;
+                }
+
+                void reach(NodeID id, PathWeight distance, uint32_t hops, NodeID parent) {
+                    m_Stamps[id] = m_Epoch;
+                    m_Distances[id] = distance;
+                    m_Hops[id] = hops;
+                    m_Parents[id] = parent;
+                }
+        };
+
+        // result of a point-to-point query
+        struct Path {
+                PathWeight distance = InfinityOf<PathWeight>();
+                uint32_t hops = InfinityOf<uint32_t>();
+                std::vector<NodeID> nodes; // source -> ... -> target, empty if unreachable
+        };
+
+        static Workspace &LocalWorkspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        // second per-thread workspace, for the backward half of Between
+        static Workspace &LocalReverseWorkspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        // full single-source run, every node reachable from source ends up settled
+        static const Workspace &Run(const CSRGraph<W> &csr, NodeID source,
+                                    Workspace &ws = LocalWorkspace()) {
+            ws.prepare(csr.NodeCount(), source);
+            ws.reach(source, PathWeight{}, 0, INVALID_NODE);
+            ws.m_Heap.Push(source, PathWeight{});
+            SPA_STAT_ONLY(ws.m_Counters.pushes++);
+
+            while (!ws.m_Heap.Empty())
+                settle_next(csr, ws);
+
+            SPA_STAT_ONLY(ws.m_Counters.Flush(ws.m_Settled.size()));
+            return ws;
+        }
+
+        // stops as soon as the k nodes nearest to source (source excluded) are settled;
+        // Settled() then holds source followed by them, by ascending distance
+        static const Workspace &KNearest(const CSRGraph<W> &csr, NodeID source, size_t k,
+                                         Workspace &ws = LocalWorkspace()) {
+            ws.prepare(csr.NodeCount(), source);
+            ws.m_Bound.reserve(k);
+            ws.reach(source, PathWeight{}, 0, INVALID_NODE);
+            ws.m_Heap.Push(source, PathWeight{});
+            SPA_STAT_ONLY(ws.m_Counters.pushes++);
+
+            while (!ws.m_Heap.Empty() && ws.m_Settled.size() <= k)
+                settle_next<true>(csr, ws, k);
+
+            SPA_STAT_ONLY(ws.m_Counters.Flush(ws.m_Settled.size()));
+            return ws;
+        }
+
+        // KNearest that also settles every node exactly as near as the k-th one, so
+        // that callers can break distance ties by ID; the bound admits all of them
+        static const Workspace &KNearestWithTies(const CSRGraph<W> &csr, NodeID source,
+                                                 size_t k, Workspace &ws = LocalWorkspace()) {
+            ws.prepare(csr.NodeCount(), source);
+            ws.m_Bound.reserve(k);
+            ws.reach(source, PathWeight{}, 0, INVALID_NODE);
+            ws.m_Heap.Push(source, PathWeight{});
+            SPA_STAT_ONLY(ws.m_Counters.pushes++);
+
+            while (!ws.m_Heap.Empty() && ws.m_Settled.size() <= k)
+                settle_next<true>(csr, ws, k);
+
+            const PathWeight last = ws.m_Distances[ws.m_Settled.back()];
+            while (!ws.m_Heap.Empty() && !(last < ws.m_Heap.Top().second))
+                settle_next<true, true>(csr, ws, k);
+
+            SPA_STAT_ONLY(ws.m_Counters.Flush(ws.m_Settled.size()));
+            return ws;
+        }
+
+        // bidirectional Dijkstra: a forward search over csr and a backward search over
+        // its transpose take turns (the smaller frontier moves), every edge that reaches
+        // a node the other side has seen proposes a path, and the search stops once the
+        // two frontier minima together cannot beat the best proposal. Among proposals of
+        // the same weight the one with fewer hops wins, but lightest paths that were not
+        // proposed by then are not searched for, so the hops are those of some lightest
+        // path rather than the fewest; exploring every tie would cost far more.
+        static Path Between(const CSRGraph<W> &csr, const CSRGraph<W> &reverse, NodeID source,
+                            NodeID target, Workspace &forward = LocalWorkspace(),
+                            Workspace &backward = LocalReverseWorkspace()) {
+            if (source == target)
+                return {PathWeight{}, 0, {source}};
+
+            forward.prepare(csr.NodeCount(), source);
+            backward.prepare(reverse.NodeCount(), target);
+            forward.reach(source, PathWeight{}, 0, INVALID_NODE);
+            forward.m_Heap.Push(source, PathWeight{});
+            backward.reach(target, PathWeight{}, 0, INVALID_NODE);
+            backward.m_Heap.Push(target, PathWeight{});
+
+            PathWeight best = InfinityOf<PathWeight>();
+            uint32_t bestHops = InfinityOf<uint32_t>();
+            NodeID meeting = INVALID_NODE;
+
+            while (!forward.m_Heap.Empty() && !backward.m_Heap.Empty()) {
+                if (!(forward.m_Heap.Top().second + backward.m_Heap.Top().second < best))
+                    break;
+
+                if (forward.m_Heap.Size() <= backward.m_Heap.Size())
+                    meet_next(csr, forward, backward, best, bestHops, meeting);
+                else
+                    meet_next(reverse, backward, forward, best, bestHops, meeting);
+            }
+
+            SPA_STAT_ONLY(forward.m_Counters.Flush(forward.m_Settled.size()));
+            SPA_STAT_ONLY(backward.m_Counters.Flush(backward.m_Settled.size()));
+
+            Path path;
+            if (meeting == INVALID_NODE)
+                return path;
+
+            // parents may have improved since the proposal, so the totals are re-read
+            path.distance = forward.Distance(meeting) + backward.Distance(meeting);
+            path.hops = forward.Hops(meeting) + backward.Hops(meeting);
+            path.nodes = forward.PathTo(meeting);
+
+            // backward parents point towards target
+            for (NodeID id = backward.m_Parents[meeting]; id != INVALID_NODE;
+                 id = backward.m_Parents[id])
+                path.nodes.push_back(id);
+
+            return path;
+        }
+
+    private:
+        // settles the next node of `ws` and checks its relaxed edges against `other`
+        static void meet_next(const CSRGraph<W> &csr, Workspace &ws, const Workspace &other,
+                              PathWeight &best, uint32_t &bestHops, NodeID &meeting) {
+            NodeID current = settle_next(csr, ws);
+            propose(ws, other, current, best, bestHops, meeting);
+
+            for (NodeID w : csr.Targets(current))
+                propose(ws, other, w, best, bestHops, meeting);
+        }
+
+        // only a node both searches reached meets: settle_next skips relaxations that
+        // would saturate a fixed-point sum, so an edge target need not be reached, and
+        // its distance slot may still hold an earlier query's value
+        static void propose(const Workspace &ws, const Workspace &other, NodeID id,
+                            PathWeight &best, uint32_t &bestHops, NodeID &meeting) {
+            if (!ws.Reached(id) || !other.Reached(id))
+                return;
+
+            PathWeight total = ws.Distance(id) + other.Distance(id);
+            uint32_t hops = ws.Hops(id) + other.Hops(id);
+
+            if (total < best || (total == best && hops < bestHops)) {
+                best = total;
+                bestHops = hops;
+                meeting = id;
+            }
+        }
+
+        // TiesOnly settles a node as near as the farthest one a search needs: everything
+        // nearer is settled already, so only the row prefix that keeps the distance
+        // (weight 0 edges) can still reach a tie
+        template <bool Bounded = false, bool TiesOnly = false>
+        static NodeID settle_next(const CSRGraph<W> &csr, Workspace &ws, size_t k = 0) {
+            auto [current, distance] = ws.m_Heap.Pop();
+            ws.m_Settled.push_back(current);
+
+            std::span<const NodeID> targets = csr.Targets(current);
+            std::span<const W> weights = csr.Weights(current);
+            const uint32_t hops = ws.m_Hops[current] + 1;
+            SPA_STAT_ONLY(ws.m_Counters.relaxations += targets.size());
+
+            for (size_t i = 0; i < targets.size(); i++) {
+                NodeID w = targets[i];
+                PathWeight candidate = distance + weights[i];
+                if constexpr (TiesOnly)
+                    if (distance < candidate)
+                        break;
+
+                // only fixed-point sums get this far, past 65536 of the heaviest edges
+                if (!(candidate < InfinityOf<PathWeight>()))
+                    continue;
+
+                if (!ws.Reached(w)) {
+                    if constexpr (Bounded)
+                        if (!ws.admit(candidate, k))
+                            continue;
+
+                    ws.reach(w, candidate, hops, current);
+                    ws.m_Heap.Push(w, candidate);
+                    SPA_STAT_ONLY(ws.m_Counters.pushes++);
+                } else if (candidate < ws.m_Distances[w] && ws.m_Heap.Contains(w)) {
+                    ws.reach(w, candidate, hops, current);
+                    ws.m_Heap.DecreaseKey(w, candidate);
+                    SPA_STAT_ONLY(ws.m_Counters.decreaseKeys++);
+                } else if (candidate == ws.m_Distances[w] && hops < ws.m_Hops[w]) {
+                    ws.reach(w, candidate, hops, current);
+                    if (!ws.m_Heap.Contains(w))
+                        spread_hops(csr, ws, w);
+                }
+            }
+
+            return current;
+        }
+
+        // a settled node got fewer hops at the same weight: nodes still in the heap
+        // pick that up when they are settled, settled ones have to be updated here
+        static void spread_hops(const CSRGraph<W> &csr, Workspace &ws, NodeID id) {
+            ws.m_Spread.push_back(id);
+
+            while (!ws.m_Spread.empty()) {
+                NodeID current = ws.m_Spread.back();
+                ws.m_Spread.pop_back();
+
+                std::span<const NodeID> targets = csr.Targets(current);
+                std::span<const W> weights = csr.Weights(current);
+                const uint32_t hops = ws.m_Hops[current] + 1;
+
+                for (size_t i = 0; i < targets.size(); i++) {
+                    NodeID w = targets[i];
+                    if (ws.Reached(w) && hops < ws.m_Hops[w] &&
+                        ws.m_Distances[current] + weights[i] == ws.m_Distances[w]) {
+                        ws.m_Hops[w] = hops;
+                        ws.m_Parents[w] = current;
+                        if (!ws.m_Heap.Contains(w))
+                            ws.m_Spread.push_back(w);
+                    }
+                }
+            }
+        }
+};
\ No newline at end of file
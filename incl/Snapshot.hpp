@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+/**
+ * @brief Versioned binary graph snapshot.
+ *
+ * LAYOUT:
+ *  SnapshotHeader
+ *  sections, each starting on a SNAPSHOT_ALIGNMENT boundary
+ *
+ * Every section is a raw array exactly as it sits in memory, so a reader maps the
+ * file and views the sections in place, without parsing or rehashing. The
+ * header records the producer's byte order and element sizes, and a snapshot
+ * written by an incompatible build is rejected instead of misread. Sections that
+ * are not present have size 0. New sections only ever take unused slots, so
+ * SNAPSHOT_VERSION is bumped when the meaning of an existing section changes.
+ */
+
+enum SnapshotSection : uint32_t {
+    SECTION_NAME_OFFSETS = 0,       // uint64_t[V + 1], string payloads only
+    SECTION_NAME_DATA,              // concatenated names, or T[V] for arithmetic payloads
+    SECTION_SYMBOL_INDEX,           // NodeID[2^k], see SymbolTable::StableIndex
+    SECTION_CSR_OFFSETS,            // uint64_t[V + 1]
+    SECTION_CSR_TARGETS,            // NodeID[E]
+    SECTION_CSR_WEIGHTS,            // W[E]
+    SECTION_WEIGHT_TABLE,           // PathWeightOf<W>[V * V], see DistanceTable
+    SECTION_HOP_TABLE,              // uint32_t[V * V]
+    SECTION_HIERARCHY_UP_OFFSETS,   // uint64_t[V + 1], see ContractionHierarchy
+    SECTION_HIERARCHY_UP_ARCS,      // ContractionHierarchy::Arc[]
+    SECTION_HIERARCHY_DOWN_OFFSETS, // uint64_t[V + 1]
+    SECTION_HIERARCHY_DOWN_ARCS,    // ContractionHierarchy::Arc[]
+    SNAPSHOT_MAX_SECTIONS = 32
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = {'S', 'P', 'A', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t SNAPSHOT_VERSION = 2; // 2: tables and shortcuts in PathWeightOf<W>
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+constexpr size_t SNAPSHOT_ALIGNMENT = 64;
+
+// set in SnapshotHeader::weightSize for integer (fixed-point) weights, which may be
+// as wide as a floating-point type but do not mean the same
+constexpr uint32_t SNAPSHOT_FIXED_POINT = 1u << 31;
+
+struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t weightSize;
+        uint32_t symbolSize; // 0 for string payloads, sizeof(T) for arithmetic ones
+        uint64_t nodeCount;
+        uint64_t edgeCount;
+
+        struct {
+                uint64_t offset;
+                uint64_t size;
+        } sections[SNAPSHOT_MAX_SECTIONS];
+};
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "snapshots assume 64-bit offsets");
+
+/**
+ * @brief Writes a snapshot next to its destination and renames it into place on
+ * Commit, so a reader never observes a half-written file.
+ */
+class SnapshotWriter {
+    private:
+        std::string m_Filename;
+        std::string m_TempName;
+        std::ofstream m_File;
+        SnapshotHeader m_Header{};
+        uint64_t m_Position = 0;
+
+    public:
+        SnapshotWriter(const std::string &filename, uint64_t nodeCount, uint64_t edgeCount,
+                       uint32_t weightSize, uint32_t symbolSize)
+            : m_Filename(filename), m_TempName(filename + ".tmp") {
+            m_File.open(m_TempName, std::ios::binary | std::ios::out | std::ios::trunc);
+            if (!m_File)
+                throw(std::runtime_error("cannot write " + m_TempName));
+
+            std::memcpy(m_Header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+            m_Header.version = SNAPSHOT_VERSION;
+            m_Header.byteOrder = SNAPSHOT_BYTE_ORDER;
+            m_Header.weightSize = weightSize;
+            m_Header.symbolSize = symbolSize;
+            m_Header.nodeCount = nodeCount;
+            m_Header.edgeCount = edgeCount;
+
+            // placeholder, the final header is written by Commit
+            write_bytes(&m_Header, sizeof(m_Header));
+        }
+
+        ~SnapshotWriter() {
+            if (m_File.is_open()) {
+                m_File.close();
+                std::filesystem::remove(m_TempName);
+            }
+        }
+
+        template <typename X> void Write(uint32_t section, std::span<const X> data) {
+            pad_to(SNAPSHOT_ALIGNMENT);
+            m_Header.sections[section].offset = m_Position;
+            m_Header.sections[section].size = data.size_bytes();
+            write_bytes(data.data(), data.size_bytes());
+        }
+
+        template <typename X> void Write(uint32_t section, const std::vector<X> &data) {
+            Write(section, std::span<const X>(data));
+        }
+
+        void Commit() {
+            m_File.seekp(0);
+            m_File.write((const char *)&m_Header, sizeof(m_Header));
+            m_File.close();
+
+            if (!m_File)
+                throw(std::runtime_error("cannot write " + m_TempName));
+
+            std::filesystem::rename(m_TempName, m_Filename);
+        }
+
+    private:
+        void write_bytes(const void *data, size_t size) {
+            m_File.write((const char *)data, size);
+            m_Position += size;
+
+            if (!m_File)
+                throw(std::runtime_error("cannot write " + m_TempName));
+        }
+
+        void pad_to(size_t alignment) {
+            static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+            write_bytes(zeros, (alignment - m_Position % alignment) % alignment);
+        }
+};
+
+/**
+ * @brief Maps a snapshot and hands out its sections as spans. The spans stay
+ * valid for as long as a copy of KeepAlive() is held.
+ */
+class SnapshotReader {
+    private:
+        std::shared_ptr<MappedFile> m_File;
+        SnapshotHeader m_Header;
+
+    public:
+        explicit SnapshotReader(const std::string &filename)
+            : m_File(std::make_shared<MappedFile>(filename, false)) {
+            if (m_File->Size() < sizeof(SnapshotHeader))
+                throw(std::runtime_error(filename + ": not a graph snapshot"));
+
+            std::memcpy(&m_Header, m_File->Data(), sizeof(SnapshotHeader));
+
+            if (std::memcmp(m_Header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+                throw(std::runtime_error(filename + ": not a graph snapshot"));
+            if (m_Header.version != SNAPSHOT_VERSION)
+                throw(std::runtime_error(filename + ": unsupported snapshot version " +
+                                         std::to_string(m_Header.version)));
+            if (m_Header.byteOrder != SNAPSHOT_BYTE_ORDER)
+                throw(std::runtime_error(filename + ": snapshot has a foreign byte order"));
+
+            for (const auto &section : m_Header.sections)
+                if (section.offset > m_File->Size() ||
+                    section.size > m_File->Size() - section.offset)
+                    throw(std::runtime_error(filename + ": truncated snapshot"));
+        }
+
+        const SnapshotHeader &Header() const { return m_Header; }
+        bool Has(uint32_t section) const { return m_Header.sections[section].size > 0; }
+
+        template <typename X> std::span<const X> Section(uint32_t section) const {
+            const auto &entry = m_Header.sections[section];
+            const char *data = m_File->Data() + entry.offset;
+
+            if (entry.size % sizeof(X) != 0 || (uintptr_t)data % alignof(X) != 0)
+                throw(std::runtime_error("malformed snapshot section " + std::to_string(section)));
+
+            return {(const X *)data, entry.size / sizeof(X)};
+        }
+
+        std::shared_ptr<const void> KeepAlive() const { return m_File; }
+};
\ No newline at end of file
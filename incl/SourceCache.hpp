@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "literals.hpp"
+
+/**
+ * @brief Memory-bounded cache of single-source query results.
+ *
+ * An entry holds the nearest targets of one source by ascending distance, either
+ * a prefix (what a k-nearest query settled) or every reachable node. Entries are
+ * evicted with the CLOCK algorithm once their estimated footprint exceeds the
+ * byte budget: a hit sets the entry's reference bit, and the hand evicts the
+ * first entry whose bit is already clear. All members lock, so the cache may be
+ * shared between query threads.
+ *
+ * @tparam W path weight data type
+ */
+template <typename W = NodeWeight> class SourceCache {
+    public:
+        static constexpr size_t DEFAULT_BUDGET = 64 << 20;
+
+        struct Target {
+                NodeID id;
+                W distance;
+                uint32_t hops;
+        };
+
+        struct Stats {
+                size_t hits = 0;
+                size_t misses = 0;
+                size_t evictions = 0;
+                size_t entries = 0;
+                size_t bytes = 0;
+                size_t budget = 0;
+        };
+
+    private:
+        struct Slot {
+                NodeID source = INVALID_NODE; // INVALID_NODE marks a free slot
+                bool referenced = false;
+                bool complete = false;
+                std::vector<Target> targets;
+        };
+
+        mutable std::mutex m_Lock;
+        std::vector<Slot> m_Slots;
+        std::vector<size_t> m_Free;
+        std::unordered_map<NodeID, size_t> m_Index;
+        size_t m_Hand = 0;
+        size_t m_Budget = DEFAULT_BUDGET;
+        Stats m_Stats;
+
+    public:
+        explicit SourceCache(size_t budget = DEFAULT_BUDGET) : m_Budget(budget) {}
+
+        // the lock itself is never shared, only the entries behind it
+        SourceCache(const SourceCache &other) { *this = other; }
+        SourceCache(SourceCache &&other) { *this = std::move(other); }
+
+        SourceCache &operator=(const SourceCache &other) {
+            if (this != &other) {
+                std::scoped_lock guard(m_Lock, other.m_Lock);
+                assign(other);
+            }
+
+            return *this;
+        }
+
+        SourceCache &operator=(SourceCache &&other) {
+            if (this != &other) {
+                std::scoped_lock guard(m_Lock, other.m_Lock);
+                assign(std::move(other));
+            }
+
+            return *this;
+        }
+
+        // a budget of 0 disables caching
+        void SetBudget(size_t bytes) {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            m_Budget = bytes;
+            shrink_to(m_Budget);
+        }
+
+        size_t Budget() const {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            return m_Budget;
+        }
+
+        // copies the `count` nearest targets of source (source itself first) into out;
+        // a miss if the entry is absent or holds fewer targets without being complete
+        bool Lookup(NodeID source, size_t count, std::vector<Target> &out) {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            auto found = m_Index.find(source);
+
+            if (found == m_Index.end() || (m_Slots[found->second].targets.size() < count &&
+                                           !m_Slots[found->second].complete)) {
+                m_Stats.misses++;
+                return false;
+            }
+
+            Slot &slot = m_Slots[found->second];
+            slot.referenced = true;
+            m_Stats.hits++;
+
+            out.assign(slot.targets.begin(),
+                       slot.targets.begin() + std::min(count, slot.targets.size()));
+            return true;
+        }
+
+        // `complete` means targets holds every node reachable from source
+        void Store(NodeID source, std::vector<Target> &&targets, bool complete) {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            const size_t bytes = footprint(targets);
+
+            erase(source);
+            if (bytes > m_Budget)
+                return;
+
+            shrink_to(m_Budget - bytes);
+
+            size_t idx = m_Slots.size();
+            if (!m_Free.empty()) {
+                idx = m_Free.back();
+                m_Free.pop_back();
+            } else {
+                m_Slots.emplace_back();
+            }
+
+            Slot &slot = m_Slots[idx];
+            slot.source = source;
+            slot.referenced = false;
+            slot.complete = complete;
+            slot.targets = std::move(targets);
+
+            m_Index[source] = idx;
+            m_Stats.entries++;
+            m_Stats.bytes += bytes;
+        }
+
+        // drops every entry, the counters keep running
+        void Clear() {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            m_Slots.clear();
+            m_Free.clear();
+            m_Index.clear();
+            m_Hand = 0;
+            m_Stats.entries = m_Stats.bytes = 0;
+        }
+
+        Stats GetStats() const {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            Stats stats = m_Stats;
+            stats.budget = m_Budget;
+            return stats;
+        }
+
+        void ResetStats() {
+            std::lock_guard<std::mutex> guard(m_Lock);
+            m_Stats.hits = m_Stats.misses = m_Stats.evictions = 0;
+        }
+
+    private:
+        template <typename Other> void assign(Other &&other) {
+            m_Slots = std::forward<Other>(other).m_Slots;
+            m_Free = std::forward<Other>(other).m_Free;
+            m_Index = std::forward<Other>(other).m_Index;
+            m_Hand = other.m_Hand;
+            m_Budget = other.m_Budget;
+            m_Stats = other.m_Stats;
+        }
+
+        // estimated heap bytes of an entry, index node included
+        static size_t footprint(const std::vector<Target> &targets) {
+            return sizeof(Slot) + targets.capacity() * sizeof(Target) +
+                   sizeof(std::pair<NodeID, size_t>) + 2 * sizeof(void *);
+        }
+
+        void erase(NodeID source) {
+            auto found = m_Index.find(source);
+            if (found == m_Index.end())
+                return;
+
+            Slot &slot = m_Slots[found->second];
+            m_Stats.bytes -= footprint(slot.targets);
+            m_Stats.entries--;
+
+            slot.source = INVALID_NODE;
+            slot.targets = {};
+            m_Free.push_back(found->second);
+            m_Index.erase(found);
+        }
+
+        void shrink_to(size_t bytes) {
+            while (m_Stats.bytes > bytes && !m_Index.empty()) {
+                if (m_Hand >= m_Slots.size())
+                    m_Hand = 0;
+
+                Slot &slot = m_Slots[m_Hand++];
+                if (slot.source == INVALID_NODE)
+                    continue;
+
+                // second chance for entries that were hit since the last sweep
+                if (slot.referenced) {
+                    slot.referenced = false;
+                    continue;
+                }
+
+                erase(slot.source);
+                m_Stats.evictions++;
+            }
+        }
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Opt-in runtime instrumentation, enabled by building with
+ * -DSPA_ENABLE_STATS. Without it every SPA_STAT_* hook expands to nothing and
+ * GetRuntimeStats() reports zeros with `enabled` unset.
+ *
+ * Hot loops count into per-run LocalCounters that are flushed into the global
+ * atomics once per run, so enabling the stats costs a few register increments
+ * per relaxation rather than contended atomics.
+ */
+
+#ifdef SPA_ENABLE_STATS
+#define SPA_STAT_ONLY(...) __VA_ARGS__
+#define SPA_STAT_ADD(counter, amount)                                                             \
+    (StatsCounters().counter.fetch_add((uint64_t)(amount), std::memory_order_relaxed))
+#define SPA_STAT_PHASE(phase) ScopedPhase spa_stat_phase_##phase(phase)
+#else
+#define SPA_STAT_ONLY(...)
+#define SPA_STAT_ADD(counter, amount) ((void)0)
+#define SPA_STAT_PHASE(phase) ((void)0)
+#endif
+
+enum StatsPhase : uint32_t {
+    PHASE_LOAD = 0,  // LoadFromFile, LoadEdgeList, LoadMatrixMarket, LoadSnapshot
+    PHASE_DISTANCES, // InitDistances, i.e. init_weights / init_edge_distances
+    PHASE_REPAIR,    // dynamic-mode table repairs
+    PHASE_DUMP,      // DumpData
+    PHASE_COUNT
+};
+
+constexpr const char *STATS_PHASE_NAMES[PHASE_COUNT] = {"load", "distances", "repair", "dump"};
+
+// a consistent-enough copy of the global counters, see GetRuntimeStats
+struct RuntimeStats {
+        bool enabled = false;
+        uint64_t sourcesRun = 0;   // single-source searches, full or k-nearest
+        uint64_t heapPushes = 0;
+        uint64_t heapPops = 0;     // equals the settled nodes
+        uint64_t decreaseKeys = 0;
+        uint64_t relaxations = 0;  // edges scanned out of settled nodes
+        uint64_t dfsVisits = 0;
+        uint64_t bytesAllocated = 0; // CSR rows, distance tables, search workspaces
+        uint64_t phaseCalls[PHASE_COUNT] = {};
+        double phaseSeconds[PHASE_COUNT] = {};
+
+        std::string ToJson() const {
+            std::string json = "{\"enabled\": " + std::string(enabled ? "true" : "false");
+            json += ", \"sources_run\": " + std::to_string(sourcesRun);
+            json += ", \"heap_pushes\": " + std::to_string(heapPushes);
+            json += ", \"heap_pops\": " + std::to_string(heapPops);
+            json += ", \"decrease_keys\": " + std::to_string(decreaseKeys);
+            json += ", \"relaxations\": " + std::to_string(relaxations);
+            json += ", \"dfs_visits\": " + std::to_string(dfsVisits);
+            json += ", \"bytes_allocated\": " + std::to_string(bytesAllocated);
+            json += ", \"phases\": {";
+
+            for (uint32_t p = 0; p < PHASE_COUNT; p++)
+                json += std::string(p ? ", " : "") + "\"" + STATS_PHASE_NAMES[p] +
+                        "\": {\"calls\": " + std::to_string(phaseCalls[p]) +
+                        ", \"seconds\": " + std::to_string(phaseSeconds[p]) + "}";
+
+            return json + "}}";
+        }
+};
+
+struct GlobalCounters {
+        std::atomic<uint64_t> sourcesRun = 0;
+        std::atomic<uint64_t> heapPushes = 0;
+        std::atomic<uint64_t> heapPops = 0;
+        std::atomic<uint64_t> decreaseKeys = 0;
+        std::atomic<uint64_t> relaxations = 0;
+        std::atomic<uint64_t> dfsVisits = 0;
+        std::atomic<uint64_t> bytesAllocated = 0;
+        std::atomic<uint64_t> phaseCalls[PHASE_COUNT] = {};
+        std::atomic<uint64_t> phaseNanoseconds[PHASE_COUNT] = {};
+};
+
+inline GlobalCounters &StatsCounters() {
+    static GlobalCounters counters;
+    return counters;
+}
+
+inline RuntimeStats GetRuntimeStats() {
+    RuntimeStats stats;
+#ifdef SPA_ENABLE_STATS
+    const GlobalCounters &counters = StatsCounters();
+    stats.enabled = true;
+    stats.sourcesRun = counters.sourcesRun;
+    stats.heapPushes = counters.heapPushes;
+    stats.heapPops = counters.heapPops;
+    stats.decreaseKeys = counters.decreaseKeys;
+    stats.relaxations = counters.relaxations;
+    stats.dfsVisits = counters.dfsVisits;
+    stats.bytesAllocated = counters.bytesAllocated;
+
+    for (uint32_t p = 0; p < PHASE_COUNT; p++) {
+        stats.phaseCalls[p] = counters.phaseCalls[p];
+        stats.phaseSeconds[p] = counters.phaseNanoseconds[p] * 1e-9;
+    }
+#endif
+    return stats;
+}
+
+inline void ResetRuntimeStats() {
+    GlobalCounters &counters = StatsCounters();
+    counters.sourcesRun = counters.heapPushes = counters.heapPops = 0;
+    counters.decreaseKeys = counters.relaxations = counters.dfsVisits = 0;
+    counters.bytesAllocated = 0;
+
+    for (uint32_t p = 0; p < PHASE_COUNT; p++)
+        counters.phaseCalls[p] = counters.phaseNanoseconds[p] = 0;
+}
+
+// per-search tallies, flushed into the global counters when the search ends
+struct LocalCounters {
+        uint64_t pushes = 0;
+        uint64_t decreaseKeys = 0;
+        uint64_t relaxations = 0;
+
+        void Flush(uint64_t settled) {
+            GlobalCounters &counters = StatsCounters();
+            counters.sourcesRun.fetch_add(1, std::memory_order_relaxed);
+            counters.heapPops.fetch_add(settled, std::memory_order_relaxed);
+            counters.heapPushes.fetch_add(pushes, std::memory_order_relaxed);
+            counters.decreaseKeys.fetch_add(decreaseKeys, std::memory_order_relaxed);
+            counters.relaxations.fetch_add(relaxations, std::memory_order_relaxed);
+            pushes = decreaseKeys = relaxations = 0;
+        }
+};
+
+// adds the wall time of its scope to a phase
+class ScopedPhase {
+    private:
+        StatsPhase m_Phase;
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        explicit ScopedPhase(StatsPhase phase)
+            : m_Phase(phase), m_Start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedPhase() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_Start);
+
+            GlobalCounters &counters = StatsCounters();
+            counters.phaseCalls[m_Phase].fetch_add(1, std::memory_order_relaxed);
+            counters.phaseNanoseconds[m_Phase].fetch_add(elapsed.count(),
+                                                          std::memory_order_relaxed);
+        }
+
+        ScopedPhase(const ScopedPhase &other) = delete;
+        ScopedPhase &operator=(const ScopedPhase &other) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "literals.hpp"
+
+// FNV-1a; unlike std::hash it is the same in every build, so tables hashed with it
+// can be persisted (see Snapshot.hpp)
+inline uint64_t StableHash(const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+    return hash;
+}
+
+template <typename Key> uint64_t StableHashOf(const Key &value) {
+    if constexpr (std::is_convertible_v<const Key &, std::string_view>) {
+        std::string_view view(value);
+        return StableHash(view.data(), view.size());
+    } else {
+        static_assert(std::is_arithmetic_v<Key>, "no stable hash for this symbol type");
+        return StableHash(&value, sizeof(value));
+    }
+}
+
+/**
+ * @brief Bidirectional mapping between node payloads and dense integer IDs.
+ * IDs are handed out in insertion order, starting from 0, and are never reused.
+ *
+ * Symbols restored from a snapshot are found through a persisted open-addressing
+ * index (m_Index) instead of being rehashed into m_IDs, which then only holds the
+ * symbols interned after the restore.
+ *
+ * @tparam T node payload data type
+ */
+template <typename T> class SymbolTable {
+    public:
+        using Symbol = T; // what Get hands out
+
+    private:
+        std::vector<T> m_Symbols;
+        std::unordered_map<T, NodeID> m_IDs;
+        Buffer<NodeID> m_Index;
+
+    public:
+        SymbolTable() {}
+
+        // returns the ID of value, assigning a fresh one if it is not yet known
+        NodeID Intern(const T &value) {
+            if (!m_Index.empty()) {
+                NodeID id = find_indexed(value);
+                if (id != INVALID_NODE)
+                    return id;
+            }
+
+            auto [it, inserted] = m_IDs.try_emplace(value, (NodeID)m_Symbols.size());
+            if (inserted)
+                m_Symbols.push_back(value);
+
+            return it->second;
+        }
+
+        // returns INVALID_NODE if value was never interned
+        template <typename Key> NodeID Find(const Key &value) const {
+            if (!m_Index.empty()) {
+                NodeID id = find_indexed(value);
+                if (id != INVALID_NODE)
+                    return id;
+            }
+
+            auto it = m_IDs.find(value);
+            return it == m_IDs.end() ? INVALID_NODE : it->second;
+        }
+
+        template <typename Key> bool Contains(const Key &value) const {
+            return Find(value) != INVALID_NODE;
+        }
+
+        // linear-probing table over StableHashOf, sized to a power of two at least twice
+        // the symbol count; empty slots hold INVALID_NODE
+        std::vector<NodeID> StableIndex() const {
+            std::vector<NodeID> index(std::bit_ceil(std::max<size_t>(2, m_Symbols.size() * 2)),
+                                      INVALID_NODE);
+            const size_t mask = index.size() - 1;
+
+            for (NodeID id = 0; id < m_Symbols.size(); id++) {
+                size_t slot = StableHashOf(m_Symbols[id]) & mask;
+                while (index[slot] != INVALID_NODE)
+                    slot = (slot + 1) & mask;
+
+                index[slot] = id;
+            }
+
+            return index;
+        }
+
+        // replaces the contents with symbols whose StableIndex was persisted; the
+        // symbols are copies here, so nothing needs to be kept alive
+        void Restore(std::vector<T> &&symbols, Buffer<NodeID> &&index,
+                     std::shared_ptr<const void> keepAlive = nullptr) {
+            if (index.size() < 2 || !std::has_single_bit(index.size()) ||
+                index.size() < symbols.size())
+                throw(std::invalid_argument("malformed symbol index"));
+
+            m_Symbols = std::move(symbols);
+            m_IDs.clear();
+            m_Index = std::move(index);
+        }
+
+        const T &Get(NodeID id) const {
+            if (id >= m_Symbols.size())
+                throw(std::out_of_range(std::to_string(id)));
+
+            return m_Symbols[id];
+        }
+
+        std::span<const T> Symbols() const { return m_Symbols; }
+        size_t Size() const { return m_Symbols.size(); }
+
+        void Reserve(size_t count) {
+            m_Symbols.reserve(count);
+            m_IDs.reserve(count);
+        }
+
+        void Clear() {
+            m_Symbols.clear();
+            m_IDs.clear();
+            m_Index = Buffer<NodeID>();
+        }
+
+    private:
+        template <typename Key> NodeID find_indexed(const Key &value) const {
+            const size_t mask = m_Index.size() - 1;
+            size_t slot = StableHashOf(value) & mask;
+
+            for (size_t probe = 0; probe < m_Index.size(); probe++, slot = (slot + 1) & mask) {
+                NodeID id = m_Index[slot];
+                if (id == INVALID_NODE || (id < m_Symbols.size() && m_Symbols[id] == value))
+                    return id;
+            }
+
+            return INVALID_NODE;
+        }
+};
+
+/**
+ * @brief String symbols, the common case. Every name is stored once, back to back in
+ * large arena blocks, and handed out as a string_view that stays valid for the
+ * lifetime of the table. There is no separate hash map: the linear-probing index
+ * that snapshots persist is the live lookup structure, so finding a name is a single
+ * probe sequence and a restored table keeps both its names and its index mapped.
+ */
+template <> class SymbolTable<std::string> {
+    public:
+        using Symbol = std::string_view; // what Get hands out
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 64 << 10;
+
+        std::vector<std::unique_ptr<char[]>> m_Blocks;
+        char *m_Cursor = nullptr; // free tail of the block being filled
+        size_t m_Left = 0;
+        std::vector<std::string_view> m_Names;
+        Buffer<NodeID> m_Index;                  // load factor kept at or below 1/2
+        std::shared_ptr<const void> m_KeepAlive; // snapshot memory restored names view
+
+    public:
+        SymbolTable() {}
+
+        // the views of the copy must point into its own blocks, so names are re-stored
+        SymbolTable(const SymbolTable &other) { *this = other; }
+        SymbolTable(SymbolTable &&other) noexcept { *this = std::move(other); }
+
+        SymbolTable &operator=(const SymbolTable &other) {
+            if (this != &other) {
+                Clear();
+                Reserve(other.Size());
+                for (std::string_view name : other.m_Names)
+                    Intern(name);
+            }
+
+            return *this;
+        }
+
+        // the blocks move along, so the views stay valid; other is left empty
+        SymbolTable &operator=(SymbolTable &&other) noexcept {
+            m_Blocks = std::move(other.m_Blocks);
+            m_Cursor = std::exchange(other.m_Cursor, nullptr);
+            m_Left = std::exchange(other.m_Left, 0);
+            m_Names = std::move(other.m_Names);
+            m_Index = std::exchange(other.m_Index, Buffer<NodeID>());
+            m_KeepAlive = std::move(other.m_KeepAlive);
+            other.m_Names.clear();
+
+            return *this;
+        }
+
+        // returns the ID of value, assigning a fresh one if it is not yet known
+        NodeID Intern(std::string_view value) {
+            if ((m_Names.size() + 1) * 2 > m_Index.size())
+                rehash(std::bit_ceil((m_Names.size() + 1) * 2));
+
+            size_t slot = find_slot(value);
+            if (m_Index[slot] != INVALID_NODE)
+                return m_Index[slot];
+
+            NodeID id = (NodeID)m_Names.size();
+            m_Names.push_back(store(value));
+            m_Index.Owned()[slot] = id;
+
+            return id;
+        }
+
+        // returns INVALID_NODE if value was never interned
+        template <typename Key> NodeID Find(const Key &value) const {
+            return m_Index.empty() ? INVALID_NODE : m_Index[find_slot(std::string_view(value))];
+        }
+
+        template <typename Key> bool Contains(const Key &value) const {
+            return Find(value) != INVALID_NODE;
+        }
+
+        // the live index already has the persisted layout (see SymbolTable<T>)
+        std::vector<NodeID> StableIndex() const {
+            if (m_Index.empty())
+                return std::vector<NodeID>(2, INVALID_NODE);
+
+            return std::vector<NodeID>(m_Index.begin(), m_Index.end());
+        }
+
+        // replaces the contents with names whose StableIndex was persisted; the views
+        // may point into memory owned by keepAlive, e.g. a mapped snapshot
+        void Restore(std::vector<std::string_view> &&names, Buffer<NodeID> &&index,
+                     std::shared_ptr<const void> keepAlive = nullptr) {
+            if (index.size() < 2 || !std::has_single_bit(index.size()) ||
+                index.size() < names.size())
+                throw(std::invalid_argument("malformed symbol index"));
+
+            m_Blocks.clear();
+            m_Cursor = nullptr;
+            m_Left = 0;
+            m_Names = std::move(names);
+            m_Index = std::move(index);
+            m_KeepAlive = std::move(keepAlive);
+        }
+
+        std::string_view Get(NodeID id) const {
+            if (id >= m_Names.size())
+                throw(std::out_of_range(std::to_string(id)));
+
+            return m_Names[id];
+        }
+
+        std::span<const std::string_view> Symbols() const { return m_Names; }
+        size_t Size() const { return m_Names.size(); }
+
+        void Reserve(size_t count) {
+            m_Names.reserve(count);
+            if (count * 2 > m_Index.size())
+                rehash(std::bit_ceil(count * 2));
+        }
+
+        void Clear() {
+            m_Blocks.clear();
+            m_Cursor = nullptr;
+            m_Left = 0;
+            m_Names.clear();
+            m_Index = Buffer<NodeID>();
+            m_KeepAlive.reset();
+        }
+
+    private:
+        // the slot holding value, or the empty slot where it would go
+        size_t find_slot(std::string_view value) const {
+            const size_t mask = m_Index.size() - 1;
+            size_t slot = StableHashOf(value) & mask;
+
+            for (size_t probe = 0; probe < m_Index.size(); probe++, slot = (slot + 1) & mask) {
+                NodeID id = m_Index[slot];
+                if (id == INVALID_NODE || (id < m_Names.size() && m_Names[id] == value))
+                    return slot;
+            }
+
+            throw(std::invalid_argument("malformed symbol index")); // full, never built so
+        }
+
+        void rehash(size_t size) {
+            std::vector<NodeID> index(size, INVALID_NODE);
+            const size_t mask = size - 1;
+
+            for (NodeID id = 0; id < m_Names.size(); id++) {
+                size_t slot = StableHashOf(m_Names[id]) & mask;
+                while (index[slot] != INVALID_NODE)
+                    slot = (slot + 1) & mask;
+
+                index[slot] = id;
+            }
+
+            m_Index = Buffer<NodeID>(std::move(index));
+        }
+
+        // copies value into the arena; names longer than a quarter block get their own
+        std::string_view store(std::string_view value) {
+            if (value.empty())
+                return {};
+
+            char *data;
+            if (value.size() > BLOCK_SIZE / 4) {
+                m_Blocks.push_back(std::make_unique<char[]>(value.size()));
+                data = m_Blocks.back().get();
+            } else {
+                if (value.size() > m_Left) {
+                    m_Blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+                    m_Cursor = m_Blocks.back().get();
+                    m_Left = BLOCK_SIZE;
+                }
+
+                data = m_Cursor;
+                m_Cursor += value.size();
+                m_Left -= value.size();
+            }
+
+            std::memcpy(data, value.data(), value.size());
+            return {data, value.size()};
+        }
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Stats.hpp"
+#include "literals.hpp"
+
+/**
+ * @brief Fixed-stride nearest-target table: row `source` holds up to K records of
+ * the targets nearest to source, ordered by (weight, hops, ID). Rows
+ * are V x K flat records plus a fill count, so the table takes O(V * K) memory
+ * where the all-pairs DistanceTable takes O(V^2), and a row is a single lookup.
+ *
+ * @tparam W path weight data type
+ */
+template <typename W = NodeWeight> class TopKTable {
+    public:
+        struct Entry {
+                NodeID id = INVALID_NODE;
+                W weight = InfinityOf<W>();
+                uint32_t hops = InfinityOf<uint32_t>(); // see DistanceTable::Hops
+        };
+
+    private:
+        size_t m_NodeCount = 0;
+        size_t m_K = 0;
+        std::vector<Entry> m_Entries;
+        std::vector<uint32_t> m_Counts;
+
+    public:
+        TopKTable() {}
+
+        // every row starts out empty
+        TopKTable(size_t nodeCount, size_t k)
+            : m_NodeCount(nodeCount), m_K(k), m_Entries(nodeCount * k), m_Counts(nodeCount, 0) {
+            SPA_STAT_ADD(bytesAllocated, MemoryUsage());
+        }
+
+        bool Empty() const { return m_NodeCount == 0; }
+        size_t NodeCount() const { return m_NodeCount; }
+        size_t K() const { return m_K; }
+
+        std::span<const Entry> Row(NodeID source) const {
+            return std::span<const Entry>(m_Entries).subspan((size_t)source * m_K,
+                                                             m_Counts[source]);
+        }
+
+        // replaces the row of source with entries (at most K of them); distinct rows
+        // may be filled from different threads
+        void SetRow(NodeID source, std::span<const Entry> entries) {
+            const size_t count = std::min(entries.size(), m_K);
+            std::copy_n(entries.begin(), count, m_Entries.begin() + (size_t)source * m_K);
+            m_Counts[source] = (uint32_t)count;
+        }
+
+        size_t MemoryUsage() const {
+            return m_Entries.capacity() * sizeof(Entry) + m_Counts.capacity() * sizeof(uint32_t);
+        }
+};
\ No newline at end of file
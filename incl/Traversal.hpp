@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CSRGraph.hpp"
+#include "Parallel.hpp"
+#include "literals.hpp"
+
+// component label of every node, labels are dense and numbered in the order of
+// the lowest node ID of each component
+struct Components {
+        std::vector<uint32_t> labels;
+        uint32_t count = 0;
+};
+
+/**
+ * @brief Unweighted traversals over a CSRGraph: depth-first search, strongly and
+ * weakly connected components.
+ *
+ * DFS runs inside a thread-local workspace whose visited marks are validated by an
+ * epoch stamp, like the ShortestPaths workspaces, so once it has been sized for a
+ * graph a traversal neither clears nor allocates anything. Adjacency rows are
+ * scanned in place.
+ *
+ * @tparam W edge weight data type, ignored
+ */
+template <typename W = NodeWeight> class Traversal {
+    public:
+        // below this many nodes the parallel WCC is not worth the atomics
+        static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+
+        // calls visit(id, order) for every node reachable from start in depth-first
+        // preorder, order counting from 1; neighbors are pushed in row order, so the
+        // last one is entered first. Returns the number of visited nodes.
+        template <typename Visit>
+        static size_t DFS(const CSRGraph<W> &csr, NodeID start, Visit &&visit) {
+            Workspace &ws = local_workspace();
+            ws.prepare(csr.NodeCount());
+            ws.m_Stack.push_back(start);
+            uint32_t order = 0;
+
+            while (!ws.m_Stack.empty()) {
+                NodeID current = ws.m_Stack.back();
+                ws.m_Stack.pop_back();
+
+                if (ws.visited(current))
+                    continue;
+
+                ws.mark(current);
+                visit(current, ++order);
+
+                for (NodeID w : csr.Targets(current))
+                    if (!ws.visited(w))
+                        ws.m_Stack.push_back(w);
+            }
+
+            return order;
+        }
+
+        // Tarjan's algorithm with an explicit call stack, so deep graphs cannot
+        // overflow the native one
+        static Components StronglyConnected(const CSRGraph<W> &csr) {
+            const size_t n = csr.NodeCount();
+            const uint32_t UNSEEN = InfinityOf<uint32_t>();
+
+            std::vector<uint32_t> index(n, UNSEEN), low(n);
+            std::vector<bool> onStack(n, false);
+            std::vector<NodeID> stack;
+            std::vector<std::pair<NodeID, size_t>> calls; // node, next edge to follow
+            std::vector<uint32_t> found(n);               // in order of completion
+            uint32_t counter = 0, count = 0;
+
+            for (NodeID root = 0; root < n; root++) {
+                if (index[root] != UNSEEN)
+                    continue;
+
+                calls.push_back({root, 0});
+                index[root] = low[root] = counter++;
+                stack.push_back(root);
+                onStack[root] = true;
+
+                while (!calls.empty()) {
+                    auto &[v, edge] = calls.back();
+                    std::span<const NodeID> targets = csr.Targets(v);
+
+                    if (edge < targets.size()) {
+                        NodeID w = targets[edge++];
+
+                        if (index[w] == UNSEEN) {
+                            index[w] = low[w] = counter++;
+                            stack.push_back(w);
+                            onStack[w] = true;
+                            calls.push_back({w, 0});
+                        } else if (onStack[w]) {
+                            low[v] = std::min(low[v], index[w]);
+                        }
+
+                        continue;
+                    }
+
+                    // v is finished: it either roots a component or hands low up
+                    const NodeID finished = v;
+                    calls.pop_back();
+
+                    if (low[finished] == index[finished]) {
+                        NodeID w;
+                        do {
+                            w = stack.back();
+                            stack.pop_back();
+                            onStack[w] = false;
+                            found[w] = count;
+                        } while (w != finished);
+
+                        count++;
+                    }
+
+                    if (!calls.empty()) {
+                        NodeID parent = calls.back().first;
+                        low[parent] = std::min(low[parent], low[finished]);
+                    }
+                }
+            }
+
+            return relabel(found);
+        }
+
+        // union-find over every edge, direction ignored; large graphs are united on
+        // the worker threads with lock-free linking
+        static Components WeaklyConnected(const CSRGraph<W> &csr, size_t threadCount = 0) {
+            const size_t n = csr.NodeCount();
+            threadCount = ResolveThreadCount(threadCount);
+
+            if (threadCount == 1 || n < PARALLEL_THRESHOLD)
+                return weakly_connected_serial(csr);
+
+            std::vector<std::atomic<NodeID>> parent(n);
+            for (NodeID id = 0; id < n; id++)
+                parent[id].store(id, std::memory_order_relaxed);
+
+            ParallelFor(
+                n, threadCount,
+                [&](size_t u, size_t) {
+                    for (NodeID v : csr.Targets((NodeID)u))
+                        unite_atomic(parent, (NodeID)u, v);
+                },
+                1024);
+
+            std::vector<uint32_t> roots(n);
+            ParallelFor(
+                n, threadCount, [&](size_t id, size_t) { roots[id] = find_atomic(parent, id); },
+                4096);
+
+            return relabel(roots);
+        }
+
+    private:
+        class Workspace {
+                friend class Traversal;
+
+            private:
+                std::vector<uint32_t> m_Stamps;
+                std::vector<NodeID> m_Stack;
+                uint32_t m_Epoch = 0;
+
+                void prepare(size_t nodeCount) {
+                    if (m_Stamps.size() < nodeCount)
+                        m_Stamps.resize(nodeCount, 0);
+
+                    if (++m_Epoch == 0) {
+                        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+                        m_Epoch = 1;
+                    }
+
+                    m_Stack.clear();
+                }
+
+                bool visited(NodeID id) const { return m_Stamps[id] == m_Epoch; }
+                void mark(NodeID id) { m_Stamps[id] = m_Epoch; }
+        };
+
+        static Workspace &local_workspace() {
+            thread_local Workspace workspace;
+            return workspace;
+        }
+
+        // dense labels numbered by the lowest node of each group
+        static Components relabel(const std::vector<uint32_t> &keys) {
+            Components components;
+            components.labels.resize(keys.size());
+            std::vector<uint32_t> label(keys.size(), InfinityOf<uint32_t>());
+
+            for (NodeID id = 0; id < keys.size(); id++) {
+                if (label[keys[id]] == InfinityOf<uint32_t>())
+                    label[keys[id]] = components.count++;
+
+                components.labels[id] = label[keys[id]];
+            }
+
+            return components;
+        }
+
+        static Components weakly_connected_serial(const CSRGraph<W> &csr) {
+            std::vector<NodeID> parent(csr.NodeCount());
+            for (NodeID id = 0; id < parent.size(); id++)
+                parent[id] = id;
+
+            auto find = [&](NodeID x) {
+                while (parent[x] != x)
+                    x = parent[x] = parent[parent[x]];
+
+                return x;
+            };
+
+            for (NodeID u = 0; u < parent.size(); u++)
+                for (NodeID v : csr.Targets(u)) {
+                    NodeID a = find(u), b = find(v);
+                    if (a != b)
+                        parent[std::max(a, b)] = std::min(a, b);
+                }
+
+            std::vector<uint32_t> roots(parent.size());
+            for (NodeID id = 0; id < parent.size(); id++)
+                roots[id] = find(id);
+
+            return relabel(roots);
+        }
+
+        // path halving, a parent is only ever replaced by one of its ancestors
+        static NodeID find_atomic(std::vector<std::atomic<NodeID>> &parent, NodeID x) {
+            while (true) {
+                NodeID p = parent[x].load(std::memory_order_relaxed);
+                if (p == x)
+                    return x;
+
+                NodeID grand = parent[p].load(std::memory_order_relaxed);
+                if (p != grand)
+                    parent[x].compare_exchange_weak(p, grand, std::memory_order_relaxed);
+
+                x = grand;
+            }
+        }
+
+        // only a root is hooked, and always below a lower ID, so no cycle can form
+        static void unite_atomic(std::vector<std::atomic<NodeID>> &parent, NodeID a, NodeID b) {
+            while (true) {
+                a = find_atomic(parent, a);
+                b = find_atomic(parent, b);
+                if (a == b)
+                    return;
+
+                if (a < b)
+                    std::swap(a, b);
+
+                NodeID expected = a;
+                if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                    return;
+            }
+        }
+};
\ No newline at end of file
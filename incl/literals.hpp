@@ -1,10 +1,59 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 using NodeWeight = double;
-using NodeID = uint8_t;
+using NodeID = uint32_t;
 
-const NodeWeight INF = std::numeric_limits<NodeWeight>::max() / 2;
\ No newline at end of file
+// halved so that INF + weight never overflows
+template <typename W> constexpr W InfinityOf() { return std::numeric_limits<W>::max() / 2; }
+
+const NodeWeight INF = InfinityOf<NodeWeight>();
+const NodeID INVALID_NODE = std::numeric_limits<NodeID>::max();
+
+// integer weight types are fixed-point with two decimals, the precision of the
+// association scores, so a uint16_t weight of 35 stands for 0.35
+template <typename W> constexpr double WEIGHT_SCALE = std::is_integral_v<W> ? 100.0 : 1.0;
+
+// path weights are summed one size up for fixed-point edges, so a uint16_t graph
+// has paths up to InfinityOf<uint32_t>() rather than 327.67; floating point
+// weights sum in their own type
+template <typename W>
+using PathWeightOf = std::conditional_t<
+    std::is_integral_v<W>,
+    std::conditional_t<(sizeof(W) < sizeof(uint32_t)),
+                       std::conditional_t<std::is_signed_v<W>, int32_t, uint32_t>,
+                       std::conditional_t<std::is_signed_v<W>, int64_t, uint64_t>>,
+    W>;
+
+// fixed-point weights have to stay below InfinityOf<W>(), so that the sum of two
+// never overflows
+template <typename W> bool WeightFits(double score) {
+    if constexpr (std::is_integral_v<W>) {
+        double scaled = std::round(score * WEIGHT_SCALE<W>);
+        return scaled >= 0 && scaled < (double)InfinityOf<W>();
+    } else {
+        return true;
+    }
+}
+
+// a score as a W, fixed-point weights are rounded to the nearest step
+template <typename W> W ToWeight(double score) {
+    if (!WeightFits<W>(score))
+        throw(std::out_of_range("weight " + std::to_string(score) + " does not fit"));
+
+    if constexpr (std::is_integral_v<W>)
+        return (W)std::round(score * WEIGHT_SCALE<W>);
+    else
+        return (W)score;
+}
+
+// the score a W stands for, the inverse of ToWeight
+template <typename W> double FromWeight(W weight) { return (double)weight / WEIGHT_SCALE<W>; }
\ No newline at end of file
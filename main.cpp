@@ -1,27 +1,534 @@
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 // build main
 // -- or --
-// g++ main.cpp -o main -g -Iincl/ -std=c++23
+// g++ main.cpp -o main -g -Iincl/ -std=c++23 -pthread
+//
+// run interactively: main
+// run a batch of queries: main --batch GRAPH [QUERIES|-] [--threads T] [--out-dir DIR]
+// serve queries: main --serve GRAPH SOCKET [--threads T], then main --query SOCKET [QUERIES|-]
 
 #include "./incl/Graph.hpp"
 #include "./incl/Node.hpp"
+#include "./incl/QueryServer.hpp"
 #include "./incl/Relation.hpp"
 #include "./incl/literals.hpp"
 
-int main(int argC, char **argV) {
-    using namespace std::string_literals;
-    using DataType = std::string;
-    using RelationType = Relation<Node<DataType>, NodeWeight>;
+using DataType = std::string;
+using GraphType = Graph<DataType>;
+
+// lines read ahead of the oldest unwritten answer, which bounds what a batch holds
+// in memory while one slow query keeps the answers after it from being written
+static constexpr size_t BATCH_WINDOW = 4096;
+
+struct Options {
+        std::string mode; // --batch, --serve or --query
+        std::string graph;
+        std::string socket;
+        std::string queries = "-"; // "-" = stdin
+        std::string outDir;        // empty = the graph default
+        size_t threads = 0;
+};
+
+static void usage() {
+    std::cout << "usage: main\n"
+                 "       main --batch GRAPH [QUERIES|-] [--threads T] [--out-dir DIR]\n"
+                 "       main --serve GRAPH SOCKET [--threads T]\n"
+                 "       main --query SOCKET [QUERIES|-]\n\n"
+                 "commands, one per line, answered one line each in input order:\n"
+                 "  knn NODE [K]    NODE [t1:w1 t2:w2 ...], the K (default 5) nearest\n"
+                 "  dist FROM TO    FROM TO WEIGHT HOPS or FROM TO unreachable\n"
+                 "  path FROM TO    FROM TO WEIGHT HOPS [n1 n2 ...] or FROM TO unreachable\n"
+                 "  dfs NODE        NODE [n1 n2 ...] in DFS visit order\n"
+                 "  dump            dump FILE, once the DumpData file is written (batch only)\n"
+                 "blank lines and lines starting with '#' are skipped\n";
+}
+
+static Options parse_options(int argC, char **argV) {
+    Options options;
+    options.mode = argV[1];
+    std::vector<std::string> positional;
+
+    for (int i = 2; i < argC; i++) {
+        std::string arg = argV[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argC)
+                throw(std::invalid_argument(arg + " expects a value"));
+            return argV[++i];
+        };
+
+        if (arg == "--threads")
+            options.threads = std::stoull(value());
+        else if (arg == "--out-dir")
+            options.outDir = value();
+        else if (arg.starts_with("--"))
+            throw(std::invalid_argument("unknown option " + arg));
+        else
+            positional.push_back(arg);
+    }
+
+    if (options.mode == "--batch" && (positional.empty() || positional.size() > 2))
+        throw(std::invalid_argument("--batch expects GRAPH [QUERIES|-]"));
+#ifndef _WIN32
+    if (options.mode == "--serve" && positional.size() != 2)
+        throw(std::invalid_argument("--serve expects GRAPH SOCKET"));
+    if (options.mode == "--query" && (positional.empty() || positional.size() > 2))
+        throw(std::invalid_argument("--query expects SOCKET [QUERIES|-]"));
+
+    if (options.mode == "--query") {
+        options.socket = positional[0];
+        if (positional.size() == 2)
+            options.queries = positional[1];
+        return options;
+    }
+
+    if (options.mode == "--serve") {
+        options.graph = positional[0];
+        options.socket = positional[1];
+        return options;
+    }
+#endif
+
+    options.graph = positional[0];
+    if (positional.size() == 2)
+        options.queries = positional[1];
+
+    return options;
+}
+
+// picks the loader by extension: .edges edge list, .mtx Matrix Market, files starting
+// with the snapshot magic are snapshots, anything else is an adjacency matrix
+static void load_graph(GraphType &graph, const std::string &filename) {
+    const std::string extension = std::filesystem::path(filename).extension().string();
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    std::ifstream(filename, std::ios::binary).read(magic, sizeof(magic));
+
+    if (std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC))
+        graph.LoadSnapshot(filename);
+    else if (extension == ".edges")
+        graph.LoadEdgeList(filename);
+    else if (extension == ".mtx")
+        graph.LoadMatrixMarket(filename);
+    else
+        graph.LoadFromFile(filename);
+}
+
+static void append_weight(std::string &out, NodeWeight weight) {
+    AppendFixed(out, FromWeight(weight), 2);
+}
+
+// answers one query line into out; only reads the graph, so several lines are answered
+// at once on different threads
+static void answer(GraphType &graph, std::string_view line, std::string &out) {
+    std::vector<std::string_view> args;
+    for (std::string_view token; !(token = NextToken(line)).empty();)
+        args.push_back(token);
+
+    auto node = [&](std::string_view name) {
+        if (graph.IdOf(DataType(name)) == INVALID_NODE)
+            throw(std::invalid_argument("unknown node \"" + std::string(name) + "\""));
+        return Node<DataType>(DataType(name));
+    };
+
+    const std::string_view command = args[0];
+    if (command == "knn" && (args.size() == 2 || args.size() == 3)) {
+        size_t k = 5;
+        if (args.size() == 3 && !ParseNumber(args[2], k))
+            throw(std::invalid_argument("malformed K \"" + std::string(args[2]) + "\""));
+
+        out += args[1];
+        out += " [";
+        for (const auto &[target, weight] : graph.KNearest(node(args[1]), k)) {
+            if (out.back() != '[')
+                out += ' ';
+
+            out += target.GetData();
+            out += ':';
+            append_weight(out, weight);
+        }
+        out += "]\n";
+    } else if ((command == "path" || command == "dist") && args.size() == 3) {
+        GraphType::Path path = graph.ShortestPath(node(args[1]), node(args[2]));
+        out += args[1];
+        out += ' ';
+        out += args[2];
+
+        if (path.nodes.empty()) {
+            out += " unreachable\n";
+            return;
+        }
+
+        out += ' ';
+        append_weight(out, path.distance);
+        out += ' ' + std::to_string(path.hops);
+        if (command == "dist") {
+            out += '\n';
+            return;
+        }
+
+        out += " [";
+        for (size_t i = 0; i < path.nodes.size(); i++) {
+            if (i > 0)
+                out += ' ';
+            out += path.nodes[i].GetData();
+        }
+        out += "]\n";
+    } else if (command == "dfs" && args.size() == 2) {
+        out += args[1];
+        out += " [";
+        graph.template DFS<void>(node(args[1]), [&](Node<DataType> visited, uint32_t) {
+            if (out.back() != '[')
+                out += ' ';
+            out += visited.GetData();
+        });
+        out += "]\n";
+    } else {
+        throw(std::invalid_argument("malformed command \"" + std::string(args[0]) + "\""));
+    }
+}
+
+static std::istream &open_queries(const Options &options, std::ifstream &file) {
+    if (options.queries == "-")
+        return std::cin;
+
+    file.open(options.queries);
+    if (!file)
+        throw(std::runtime_error("cannot open " + options.queries));
+
+    return file;
+}
+
+/**
+ * @brief Streams a batch through the shared WorkerPool. A reader thread fills a
+ * window of BATCH_WINDOW lines, the workers take them in input order, and whichever
+ * worker completes the oldest unwritten line writes every answer that is ready
+ * from there on. Reading, answering and writing thus overlap, and a slow query only
+ * holds back the output behind it, not the other workers.
+ *
+ * "dump" and building the transpose (queued ahead of the first path query) are
+ * barriers: the workers stop in front of them, the barrier runs on the full pool
+ * once everything before it is written, and the workers resume.
+ */
+class BatchPipeline {
+    private:
+        enum SlotKind { SLOT_QUERY, SLOT_PREPARE, SLOT_DUMP };
+
+        struct Slot {
+                SlotKind kind = SLOT_QUERY;
+                size_t line = 0;
+                std::string query;
+                std::string answer;
+                bool done = false;
+        };
+
+        GraphType &m_Graph;
+        size_t m_ThreadCount;
+        std::vector<Slot> m_Slots; // line i lives in m_Slots[i % BATCH_WINDOW]
+
+        std::mutex m_Lock;
+        std::mutex m_OutputLock; // taken under m_Lock, so bursts are written in order
+        std::condition_variable m_Ready; // a line was read, or the input ended
+        std::condition_variable m_Space; // answers were written
+        size_t m_Read = 0;
+        size_t m_Claimed = 0;
+        size_t m_Written = 0;
+        bool m_Closed = false;
+        bool m_Failed = false;
+
+    public:
+        BatchPipeline(GraphType &graph, size_t threads)
+            : m_Graph(graph), m_ThreadCount(ResolveThreadCount(threads)),
+              m_Slots(BATCH_WINDOW) {}
+
+        // answers every line of input, false if any of them failed
+        bool Run(std::istream &input) {
+            std::thread reader([&] { read(input); });
+
+            while (true) {
+                ParallelFor(m_ThreadCount, m_ThreadCount, [&](size_t, size_t) { work(); });
+
+                std::unique_lock<std::mutex> guard(m_Lock);
+                if (m_Claimed == m_Read && m_Closed)
+                    break;
+
+                // the workers stopped in front of a barrier, and all before it is written
+                Slot &slot = m_Slots[m_Claimed % BATCH_WINDOW];
+                guard.unlock();
+                run_barrier(slot);
+
+                guard.lock();
+                m_Claimed++;
+                slot.done = true;
+                write_ready(guard);
+            }
+
+            reader.join();
+            std::cout.flush();
+            return !m_Failed;
+        }
+
+    private:
+        void read(std::istream &input) {
+            bool prepared = false;
+            size_t number = 0;
+
+            for (std::string line; std::getline(input, line);) {
+                number++;
+                std::string_view rest = line;
+                std::string_view command = NextToken(rest);
+                if (command.empty() || command.front() == '#')
+                    continue;
+
+                // the transpose only serves path queries, so it waits for the first one
+                if (!prepared && (command == "path" || command == "dist")) {
+                    push(SLOT_PREPARE, number, std::string());
+                    prepared = true;
+                }
+
+                const SlotKind kind = command == "dump" ? SLOT_DUMP : SLOT_QUERY;
+                push(kind, number, std::move(line));
+            }
+
+            std::lock_guard<std::mutex> guard(m_Lock);
+            m_Closed = true;
+            m_Ready.notify_all();
+        }
+
+        void push(SlotKind kind, size_t line, std::string query) {
+            std::unique_lock<std::mutex> guard(m_Lock);
+            m_Space.wait(guard, [&] { return m_Read - m_Written < BATCH_WINDOW; });
+
+            Slot &slot = m_Slots[m_Read % BATCH_WINDOW];
+            slot.kind = kind;
+            slot.line = line;
+            slot.query = std::move(query);
+            slot.answer.clear();
+            slot.done = false;
+            m_Read++;
+
+            if (kind == SLOT_QUERY)
+                m_Ready.notify_one();
+            else
+                m_Ready.notify_all(); // every worker has to stop in front of it
+        }
 
+        // answers lines until the input ends or a barrier is next
+        void work() {
+            std::unique_lock<std::mutex> guard(m_Lock);
+
+            while (true) {
+                m_Ready.wait(guard, [&] { return m_Claimed < m_Read || m_Closed; });
+                if (m_Claimed == m_Read || m_Slots[m_Claimed % BATCH_WINDOW].kind != SLOT_QUERY)
+                    return;
+
+                Slot &slot = m_Slots[m_Claimed++ % BATCH_WINDOW];
+                guard.unlock();
+
+                bool failed = false;
+                try {
+                    answer(m_Graph, slot.query, slot.answer);
+                } catch (const std::exception &e) {
+                    slot.answer = error_line(slot, e);
+                    failed = true;
+                }
+
+                guard.lock();
+                slot.done = true;
+                m_Failed |= failed;
+                write_ready(guard);
+            }
+        }
+
+        void run_barrier(Slot &slot) {
+            if (slot.kind == SLOT_PREPARE) {
+                m_Graph.PrepareQueries();
+                return;
+            }
+
+            try {
+                slot.answer = "dump " + m_Graph.DumpData() + "\n";
+            } catch (const std::exception &e) {
+                slot.answer = error_line(slot, e);
+                std::lock_guard<std::mutex> guard(m_Lock);
+                m_Failed = true;
+            }
+        }
+
+        // writes the answers from the oldest unwritten line up to the first one still
+        // being answered; called with m_Lock held, which it drops while writing
+        void write_ready(std::unique_lock<std::mutex> &guard) {
+            std::string out;
+            while (m_Written < m_Claimed && m_Slots[m_Written % BATCH_WINDOW].done)
+                out += m_Slots[m_Written++ % BATCH_WINDOW].answer;
+
+            if (out.empty())
+                return;
+
+            // nothing else is read yet, so a reader on the other end may be waiting
+            const bool idle = m_Written == m_Read;
+            m_Space.notify_one();
+
+            {
+                std::lock_guard<std::mutex> output(m_OutputLock);
+                guard.unlock();
+                std::cout.write(out.data(), out.size());
+                if (idle)
+                    std::cout.flush();
+            }
+
+            guard.lock();
+        }
+
+        static std::string error_line(const Slot &slot, const std::exception &e) {
+            return "error: line " + std::to_string(slot.line) + ": " + e.what() + "\n";
+        }
+};
+
+// answers queries with a BatchPipeline. Only what the queries need is computed: knn
+// and path search on demand, dump fills the top-k table, nothing builds the
+// all-pairs table.
+static int batch(const Options &options) {
+    GraphType graph;
+    graph.SetThreadCount(options.threads);
+    if (!options.outDir.empty())
+        graph.SetOutDir((std::filesystem::path(options.outDir) / "").string());
+
+    load_graph(graph, options.graph);
+    graph.GetCSR();
+
+    std::ifstream file;
+    std::istream &input = open_queries(options, file);
+
+    // the reader thread reads std::cin while the workers write std::cout
+    std::cin.tie(nullptr);
+
+    BatchPipeline pipeline(graph, options.threads);
+    return pipeline.Run(input) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#ifndef _WIN32
+// QueryServer.hpp is empty on Windows, so --serve and --query are Unix only
+static std::atomic<QueryServer *> g_Server = nullptr;
+
+// routes SIGINT and SIGTERM to Stop for as long as it lives; the default handlers
+// are back before the server goes away
+struct StopOnSignal {
+        explicit StopOnSignal(QueryServer &server) {
+            g_Server = &server;
+            std::signal(SIGINT, stop);
+            std::signal(SIGTERM, stop);
+        }
+
+        ~StopOnSignal() {
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            g_Server = nullptr;
+        }
+
+        static void stop(int) {
+            if (QueryServer *server = g_Server)
+                server->Stop();
+        }
+};
+
+// loads the graph once and answers framed queries on the socket until SIGINT or
+// SIGTERM; the server logs request latencies to stderr
+static int serve(const Options &options) {
+    GraphType graph;
+    graph.SetThreadCount(options.threads);
+    load_graph(graph, options.graph);
+    graph.PrepareQueries();
+
+    QueryServer server(
+        options.socket,
+        [&graph](std::string_view request, std::string &response) {
+            std::string_view rest = request;
+            if (NextToken(rest).empty())
+                throw(std::invalid_argument("empty command"));
+
+            answer(graph, request, response);
+            if (!response.empty() && response.back() == '\n')
+                response.pop_back();
+        },
+        options.threads);
+
+    StopOnSignal stopOnSignal(server);
+    std::cerr << "[server] " << graph.GetCSR().NodeCount() << " nodes, listening on "
+              << options.socket << std::endl;
+    server.Run();
+    return EXIT_SUCCESS;
+}
+
+// sends queries to a server one at a time, printing the answers like batch mode
+// and the server-side latencies on stderr
+static int query(const Options &options) {
+    QueryClient client(options.socket);
+    std::ifstream file;
+    std::istream &input = open_queries(options, file);
+
+    LatencyStats latencies;
+    std::string response;
+    size_t number = 0;
+    for (std::string line; std::getline(input, line);) {
+        number++;
+        std::string_view rest = line;
+        std::string_view command = NextToken(rest);
+        if (command.empty() || command.front() == '#')
+            continue;
+
+        uint32_t micros = 0;
+        const bool ok = client.Request(line, response, &micros);
+        latencies.Add(micros, !ok);
+
+        if (ok)
+            std::cout << response << '\n';
+        else
+            std::cout << "error: line " << number << ": " << response << '\n';
+    }
+
+    std::cout.flush();
+    std::cerr << "[client] " << latencies.ToJson() << std::endl;
+    return latencies.errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif
+
+// writes the DumpData file, a missing output directory is reported like a load error
+static int save(GraphType &graph) {
+    try {
+        graph.DumpData();
+    } catch (const std::exception &e) {
+        std::cout << "[!] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Done." << std::endl;
+    return EXIT_SUCCESS;
+}
+
+static int interactive() {
     std::string filename;
     std::cout << "Naziv tekstualnog fajla: ";
     std::getline(std::cin, filename, '\n');
 
-    Graph<DataType> graph;
-    graph.LoadFromFile(filename);
-    graph.InitDistances();
+    GraphType graph;
+    try {
+        graph.LoadFromFile(filename);
+    } catch (const std::exception &e) {
+        std::cout << "[!] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // distances are computed by the first option that needs them
     std::cout << graph << std::endl;
 
     std::string sel = "1";
@@ -38,7 +545,7 @@ int main(int argC, char **argV) {
             std::getline(std::cin, name, '\n');
 
             graph.template DFS<void>(Node<DataType>(name),
-                                     [](Node<DataType> node, int16_t i) {
+                                     [](Node<DataType> node, uint32_t i) {
                                          std::cout << i++ << ". " << node << std::endl;
                                      });
         } else if (sel == "2") {
@@ -52,17 +559,44 @@ int main(int argC, char **argV) {
             std::getline(std::cin, name, '\n');
             graph.printWeightDistances(name);
         } else if (sel == "4") {
-            graph.DumpData();
-            std::cout << "Done." << std::endl;
-            return EXIT_SUCCESS;
+            return save(graph);
         } else {
             std::cout << "Invalid option." << std::endl;
         }
     } while (sel == "1" || sel == "2" || sel == "3" || sel == "4");
 
-    graph.DumpData();
+    return save(graph);
+}
 
-    std::cout << "Done." << std::endl;
-    std::cout << "Done." << std::endl;
-    return EXIT_SUCCESS;
+int main(int argC, char **argV) {
+    if (argC == 1)
+        return interactive();
+
+    const std::string_view mode = argV[1];
+    if (mode != "--batch" && mode != "--serve" && mode != "--query") {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+#ifdef _WIN32
+    if (mode != "--batch") {
+        std::cout << "[!] " << mode << " is unsupported on this platform" << std::endl;
+        return EXIT_FAILURE;
+    }
+#endif
+
+    try {
+        Options options = parse_options(argC, argV);
+#ifndef _WIN32
+        if (mode == "--serve")
+            return serve(options);
+        if (mode == "--query")
+            return query(options);
+#endif
+
+        return batch(options);
+    } catch (const std::exception &e) {
+        std::cout << "[!] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "./../incl/Graph.hpp"
+#include <iostream>
+
+int main() {
+    using RelationType = Relation<Node<std::string>, NodeWeight>;
+
+    Graph<std::string> graph;
+    graph.Connect({RelationType(Node<std::string>("a"), Node<std::string>("b"), 0.5),
+                   RelationType(Node<std::string>("a"), Node<std::string>("c"), 0.25),
+                   RelationType(Node<std::string>("c"), Node<std::string>("b"), 0.1)});
+
+    const CSRGraph<NodeWeight> &csr = graph.GetCSR();
+    std::cout << "nodes: " << csr.NodeCount() << ", edges: " << csr.EdgeCount() << std::endl;
+
+    // rows are sorted by weight, so "c" comes before "b"
+    NodeID a = graph.IdOf("a");
+    for (NodeID target : csr.Targets(a))
+        std::cout << graph.DataOf(target) << " ";
+    std::cout << std::endl;
+
+    auto distances = graph.Dijkstra(Node<std::string>("a"));
+    for (const auto &[node, dist] : distances)
+        std::cout << node << " = " << dist << std::endl;
+
+    // a -> c -> b beats the direct edge
+    auto path = graph.ShortestPath(Node<std::string>("a"), Node<std::string>("b"));
+    std::cout << "a -> b = " << path.distance << " in " << path.hops << " hops:";
+    for (const Node<std::string> &node : path.nodes)
+        std::cout << " " << node;
+    std::cout << std::endl;
+
+    // the same query answered by the contraction hierarchy
+    graph.BuildHierarchy();
+    path = graph.ShortestPath(Node<std::string>("a"), Node<std::string>("b"));
+    std::cout << "a -> b = " << path.distance << " in " << path.hops << " hops" << std::endl;
+
+    // no cycles, so every node is a component of its own, but all are connected
+    std::cout << "strongly connected: " << graph.StronglyConnectedComponents().size()
+              << ", weakly connected: " << graph.WeaklyConnectedComponents().size() << std::endl;
+
+    // fixed-point weights count hundredths, 35 = 0.35
+    using FixedRelation = Relation<Node<std::string>, uint16_t>;
+    Graph<std::string, uint16_t> fixed;
+    fixed.Connect({FixedRelation(Node<std::string>("a"), Node<std::string>("b"), 50),
+                   FixedRelation(Node<std::string>("a"), Node<std::string>("c"), 25),
+                   FixedRelation(Node<std::string>("c"), Node<std::string>("b"), 10)});
+
+    auto fixedPath = fixed.ShortestPath(Node<std::string>("a"), Node<std::string>("b"));
+    std::cout << "a -> b = " << FromWeight(fixedPath.distance) << " (fixed-point)" << std::endl;
+
+    // p -> q -> r weighs 400.00, past what a uint16_t holds, so it is only found
+    // because paths are summed in PathWeightOf<uint16_t>; the earlier queries leave
+    // distances in r's slot that the bidirectional search must not take for a meeting
+    fixed.Connect({FixedRelation(Node<std::string>("p"), Node<std::string>("q"), 20000),
+                   FixedRelation(Node<std::string>("q"), Node<std::string>("r"), 20000),
+                   FixedRelation(Node<std::string>("s"), Node<std::string>("r"), 100),
+                   FixedRelation(Node<std::string>("r"), Node<std::string>("t"), 100)});
+
+    fixed.ShortestPath(Node<std::string>("s"), Node<std::string>("t"));
+    fixed.ShortestPath(Node<std::string>("q"), Node<std::string>("t"));
+    fixedPath = fixed.ShortestPath(Node<std::string>("p"), Node<std::string>("r"));
+    std::cout << "p -> r = " << FromWeight(fixedPath.distance) << " in " << fixedPath.hops
+              << " hops (fixed-point)" << std::endl;
+    if (fixedPath.distance != 40000 || fixedPath.nodes.size() != 3)
+        return EXIT_FAILURE;
+
+    // y and x sit at distance 0 and are skipped, yet two closest targets remain
+    Graph<std::string> zero;
+    zero.Connect({RelationType(Node<std::string>("z"), Node<std::string>("y"), 0),
+                  RelationType(Node<std::string>("z"), Node<std::string>("x"), 0),
+                  RelationType(Node<std::string>("z"), Node<std::string>("w"), 0.3),
+                  RelationType(Node<std::string>("y"), Node<std::string>("v"), 0.2)});
+
+    auto closest = zero.GetClosest(Node<std::string>("z"), 2);
+    for (const auto &[node, dist] : closest)
+        std::cout << "z -> " << node << " = " << dist << std::endl;
+    if (closest.size() != 2)
+        return EXIT_FAILURE;
+
+    graph.TryDisconnect(Node<std::string>("a"), Node<std::string>("c"));
+    std::cout << graph << std::endl;
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
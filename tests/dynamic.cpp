@@ -0,0 +1,40 @@
+#include "./../incl/Graph.hpp"
+#include <iostream>
+
+int main() {
+    using RelationType = Relation<Node<std::string>, NodeWeight>;
+
+    Graph<std::string> graph;
+    graph.Connect({RelationType(Node<std::string>("a"), Node<std::string>("b"), 0.5),
+                   RelationType(Node<std::string>("b"), Node<std::string>("c"), 0.5),
+                   RelationType(Node<std::string>("a"), Node<std::string>("c"), 2.0)});
+
+    // the table is computed once, later updates only repair the rows they touch
+    graph.SetDynamic(true);
+    graph.InitDistances();
+
+    auto show = [&graph](const char *what) {
+        const DistanceTable<NodeWeight> &table = graph.GetDistances();
+        NodeID a = graph.IdOf("a");
+
+        std::cout << what << ":";
+        for (NodeID target = 0; target < table.NodeCount(); target++)
+            if (table.Reachable(a, target))
+                std::cout << " " << graph.DataOf(target) << "=" << table.Weight(a, target) << "/"
+                          << table.Hops(a, target);
+        std::cout << std::endl;
+    };
+
+    show("initial");
+
+    graph.Connect(RelationType(Node<std::string>("c"), Node<std::string>("d"), 0.25));
+    show("c -> d added");
+
+    graph.TryDisconnect(Node<std::string>("b"), Node<std::string>("c"));
+    show("b -> c removed");
+
+    graph.SetWeight(Node<std::string>("a"), Node<std::string>("c"), 0.75);
+    show("a -> c lowered");
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file